@@ -24,13 +24,64 @@
 #include "async.h"
 #include "error.h"
 #include "log.h"
+#include "renderer-service-upnp.h"
+
+/* Cancellables are reset and kept for reuse, up to
+ * RSU_ASYNC_CANCELLABLE_POOL_SIZE of them.  The handler of a cancelled
+ * task is still connected when the task is deleted, so it is
+ * disconnected first.  A cancellable still having other handlers is
+ * dropped, as those handlers may refer to the deleted task. */
+#define RSU_ASYNC_CANCELLABLE_POOL_SIZE 32
+
+static GCancellable *g_cancellable_pool[RSU_ASYNC_CANCELLABLE_POOL_SIZE];
+static guint g_cancellable_pool_count;
+static guint64 g_cancellable_allocated;
+static guint64 g_cancellable_reused;
+
+GCancellable *rsu_async_cancellable_new(void)
+{
+	if (!g_cancellable_pool_count) {
+		++g_cancellable_allocated;
+		return g_cancellable_new();
+	}
+
+	++g_cancellable_reused;
+
+	return g_cancellable_pool[--g_cancellable_pool_count];
+}
+
+static void prv_async_cancellable_free(GCancellable *cancellable,
+				       gulong cancel_id)
+{
+	if (cancel_id && g_signal_handler_is_connected(cancellable, cancel_id))
+		g_cancellable_disconnect(cancellable, cancel_id);
+
+	if (g_cancellable_pool_count < RSU_ASYNC_CANCELLABLE_POOL_SIZE &&
+	    !g_signal_has_handler_pending(cancellable,
+					  g_signal_lookup("cancelled",
+							  G_TYPE_CANCELLABLE),
+					  0, FALSE)) {
+		g_cancellable_reset(cancellable);
+		g_cancellable_pool[g_cancellable_pool_count++] = cancellable;
+	} else {
+		g_object_unref(cancellable);
+	}
+}
 
 void rsu_async_task_delete(rsu_async_task_t *task)
 {
 	if (task->free_private)
 		task->free_private(task->private);
 	if (task->cancellable)
-		g_object_unref(task->cancellable);
+		prv_async_cancellable_free(task->cancellable, task->cancel_id);
+}
+
+void rsu_async_add_statistics(GVariantBuilder *vb)
+{
+	g_variant_builder_add(vb, "{sv}", "CancellablesAllocated",
+			      g_variant_new_uint64(g_cancellable_allocated));
+	g_variant_builder_add(vb, "{sv}", "CancellablesReused",
+			      g_variant_new_uint64(g_cancellable_reused));
 }
 
 gboolean rsu_async_task_complete(gpointer user_data)
@@ -49,6 +100,12 @@ gboolean rsu_async_task_complete(gpointer user_data)
 	return FALSE;
 }
 
+void rsu_async_task_defer_complete(rsu_async_task_t *cb_data)
+{
+	rsu_task_processor_defer(rsu_renderer_service_get_task_processor(),
+				 rsu_async_task_complete, cb_data);
+}
+
 void rsu_async_task_cancelled(GCancellable *cancellable, gpointer user_data)
 {
 	rsu_async_task_t *cb_data = user_data;
@@ -60,7 +117,7 @@ void rsu_async_task_cancelled(GCancellable *cancellable, gpointer user_data)
 	if (!cb_data->error)
 		cb_data->error = g_error_new(RSU_ERROR, RSU_ERROR_CANCELLED,
 					     "Operation cancelled.");
-	(void) g_idle_add(rsu_async_task_complete, cb_data);
+	rsu_async_task_defer_complete(cb_data);
 }
 
 void rsu_async_task_cancel(rsu_async_task_t *task)
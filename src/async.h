@@ -43,8 +43,11 @@ struct rsu_async_task_t_ {
 	rsu_device_t *device;
 };
 
+GCancellable *rsu_async_cancellable_new(void);
 gboolean rsu_async_task_complete(gpointer user_data);
+void rsu_async_task_defer_complete(rsu_async_task_t *cb_data);
 void rsu_async_task_cancelled(GCancellable *cancellable, gpointer user_data);
 void rsu_async_task_delete(rsu_async_task_t *task);
 void rsu_async_task_cancel(rsu_async_task_t *task);
+void rsu_async_add_statistics(GVariantBuilder *vb);
 #endif
@@ -29,9 +29,12 @@
 
 #include "async.h"
 #include "device.h"
+#include "duration.h"
 #include "error.h"
+#include "last-change.h"
 #include "log.h"
 #include "prop-defs.h"
+#include "protocol-info.h"
 #include "service-task.h"
 
 typedef void (*rsu_device_local_cb_t)(rsu_async_task_t *cb_data);
@@ -41,6 +44,22 @@ struct rsu_device_data_t_ {
 	rsu_device_local_cb_t local_cb;
 };
 
+/* A GetPositionInfo action in progress on a device.  Every Position read
+ * issued while it is in progress, by any client, waits for its result
+ * instead of sending a new action.  The position poller gives up on a
+ * read that takes too long, which is then abandoned until the reads of
+ * the clients still waiting for it complete or time out. */
+struct rsu_device_position_read_t_ {
+	rsu_device_t *device;
+	GUPnPServiceProxy *proxy;
+	GUPnPServiceProxyAction *action;
+	GPtrArray *waiters;
+	guint epoch;
+	gint64 started;
+	gboolean polled;
+	gboolean abandoned;
+};
+
 /* Private structure used in chain task */
 typedef struct prv_new_device_ct_t_ prv_new_device_ct_t;
 struct prv_new_device_ct_t_ {
@@ -48,11 +67,74 @@ struct prv_new_device_ct_t_ {
 	rsu_interface_info_t *interface_info;
 };
 
+/* Maximum age, in seconds, of a position sample used to compute the
+ * Position of a device.  0 disables the interpolation. */
+static guint g_position_resync_interval;
+
+/* Time, in milliseconds, during which property changes are merged before
+ * being signalled.  0 signals every change straight away. */
+static guint g_properties_changed_window;
+
+/* Time, in seconds, after which the position poller gives up on a read,
+ * the task timeout.  When it is 0, the poller gives up after
+ * RSU_DEVICE_POSITION_READ_POLLS intervals. */
+static guint g_position_read_timeout;
+
+/* Shortest interval, in milliseconds, between two position polls */
+#define RSU_DEVICE_POSITION_MIN_INTERVAL 100
+
+/* Number of poll intervals after which the position poller gives up on a
+ * read, when there is no task timeout */
+#define RSU_DEVICE_POSITION_READ_POLLS 10
+
+/* Difference, in microseconds, between the position reported by a device
+ * and the position expected from the previous one above which the device
+ * is considered to have seeked */
+#define RSU_DEVICE_SEEK_TOLERANCE 1000000
+
+/* Number of parsed CurrentTrackMetaData kept, for all devices, so that
+ * the DIDL-Lite sent again by a renderer for the same track is not parsed
+ * again */
+#define RSU_DEVICE_META_DATA_CACHE_SIZE 16
+
+typedef struct prv_meta_data_cache_entry_t_ prv_meta_data_cache_entry_t;
+struct prv_meta_data_cache_entry_t_ {
+	gchar *didl;
+	GHashTable *meta_data;
+	GList link;
+};
+
+/* Raw metadata to cache entry, entries most recently used first */
+static GHashTable *g_meta_data_cache;
+static GQueue g_meta_data_lru = G_QUEUE_INIT;
+static GUPnPDIDLLiteParser *g_didl_parser;
+
+/* Service descriptions are fetched asynchronously, once per SCPD URL for
+ * all the devices, which usually share them when they are of the same
+ * model.  Only the values the service needs are kept: the allowed play
+ * speeds of AVTransport and the maximum volume of RenderingControl. */
+
+typedef struct prv_scpd_t_ prv_scpd_t;
+struct prv_scpd_t_ {
+	gchar *url;
+	gboolean fetched;
+	GPtrArray *rates;
+	guint max_volume;
+	GPtrArray *waiters;
+	GUPnPServiceProxy *proxy;
+};
+
+/* SCPD URL to description, for all devices */
+static GHashTable *g_scpd_cache;
+
 static void prv_last_change_cb(GUPnPServiceProxy *proxy,
 			       const char *variable,
 			       GValue *value,
 			       gpointer user_data);
 
+static void prv_position_read_abort(rsu_device_position_read_t *read,
+				    const GError *error);
+
 static void prv_sink_change_cb(GUPnPServiceProxy *proxy,
 			       const char *variable,
 			       GValue *value,
@@ -65,6 +147,10 @@ static void prv_rc_last_change_cb(GUPnPServiceProxy *proxy,
 
 static void prv_props_update(rsu_device_t *device, rsu_task_t *task);
 
+static prv_scpd_t *prv_scpd_get(GUPnPServiceProxy *proxy);
+
+static void prv_scpd_forget_device(rsu_device_t *device);
+
 static void prv_unref_variant(gpointer variant)
 {
 	GVariant *var = variant;
@@ -74,20 +160,25 @@ static void prv_unref_variant(gpointer variant)
 
 static void prv_props_init(rsu_props_t *props)
 {
-	props->root_props = g_hash_table_new_full(g_str_hash, g_str_equal,
-						  NULL, prv_unref_variant);
-	props->player_props = g_hash_table_new_full(g_str_hash, g_str_equal,
-						    NULL, prv_unref_variant);
-	props->device_props = g_hash_table_new_full(g_str_hash, g_str_equal,
-						    NULL, prv_unref_variant);
+	memset(props->values, 0, sizeof(props->values));
 	props->synced = FALSE;
 }
 
 static void prv_props_free(rsu_props_t *props)
 {
-	g_hash_table_unref(props->root_props);
-	g_hash_table_unref(props->player_props);
-	g_hash_table_unref(props->device_props);
+	guint i;
+
+	for (i = 0; i < RSU_PROP_MAX; ++i)
+		prv_unref_variant(props->values[i]);
+}
+
+/* Takes ownership of value */
+
+static void prv_props_set(rsu_props_t *props, rsu_prop_t prop,
+			  GVariant *value)
+{
+	prv_unref_variant(props->values[prop]);
+	props->values[prop] = value;
 }
 
 static void prv_service_proxies_free(rsu_service_proxies_t *service_proxies)
@@ -166,27 +257,43 @@ static void prv_rsu_context_delete(gpointer context)
 	}
 }
 
-static void prv_change_props(GHashTable *props,
-			     const gchar *key,
-			     GVariant *value,
-			     GVariantBuilder *changed_props_vb)
+/* Takes ownership of value.  Renderers often resend their whole state in
+ * their events, so a value equal to the cached one is not reported as a
+ * change.  Returns TRUE if the value changed. */
+
+static gboolean prv_change_props(rsu_props_t *props,
+				 rsu_prop_t prop,
+				 GVariant *value,
+				 GVariantBuilder *changed_props_vb)
 {
-	g_hash_table_insert(props, (gpointer) key, value);
+	GVariant *current = props->values[prop];
+
+	if (current && g_variant_equal(current, value)) {
+		g_variant_unref(value);
+		return FALSE;
+	}
+
+	prv_props_set(props, prop, value);
 	if (changed_props_vb)
-		g_variant_builder_add(changed_props_vb, "{sv}", key, value);
+		g_variant_builder_add(changed_props_vb, "{sv}",
+				      rsu_prop_get_name(prop), value);
+
+	return TRUE;
 }
 
-static void prv_emit_signal_properties_changed(rsu_device_t *device,
-					       const char *interface,
-					       GVariant *changed_props)
+static void prv_emit_properties_changed_now(rsu_device_t *device,
+					    const char *interface,
+					    GVariant *changed_props)
 {
 #if RSU_LOG_LEVEL & RSU_LOG_LEVEL_DEBUG
 	gchar *params;
 #endif
-	GVariant *val = g_variant_ref_sink(g_variant_new("(s@a{sv}as)",
-					   interface,
-					   changed_props,
-					   NULL));
+	GVariant *val;
+
+	val = g_variant_ref_sink(g_variant_new("(s@a{sv}as)",
+					       interface,
+					       changed_props,
+					       NULL));
 
 	RSU_LOG_DEBUG("Emitted Signal: %s.%s - ObjectPath: %s",
 		      RSU_INTERFACE_PROPERTIES,
@@ -210,46 +317,154 @@ static void prv_emit_signal_properties_changed(rsu_device_t *device,
 	g_variant_unref(val);
 }
 
-static void prv_merge_meta_data(rsu_device_t *device,
-				const gchar *key,
-				GVariant *value,
-				GVariantBuilder *changed_props_vb)
+static void prv_flush_properties_changed(rsu_device_t *device)
 {
-	GVariant *current_meta_data;
-	GVariantIter viter;
-	GVariantBuilder *vb;
-	GVariant *val;
-	gchar *vkey;
-	gboolean replaced = FALSE;
-	GVariant *new_val;
+	GHashTableIter iter;
+	GHashTableIter prop_iter;
+	gpointer interface;
+	gpointer props;
+	gpointer key;
+	gpointer value;
+	GVariantBuilder vb;
 
-	vb = g_variant_builder_new(G_VARIANT_TYPE("a{sv}"));
+	if (device->changes_id) {
+		(void) g_source_remove(device->changes_id);
+		device->changes_id = 0;
+	}
 
-	current_meta_data = g_hash_table_lookup(device->props.player_props,
-						RSU_INTERFACE_PROP_METADATA);
-	if (current_meta_data) {
-		g_variant_iter_init(&viter, current_meta_data);
-		while (g_variant_iter_next(&viter, "{&sv}", &vkey, &val)) {
-			if (!strcmp(key, vkey)) {
-				new_val = value;
-				replaced = TRUE;
-			} else {
-				new_val = val;
-			}
-			g_variant_builder_add(vb, "{sv}", vkey, new_val);
-			g_variant_unref(val);
-		}
+	g_hash_table_iter_init(&iter, device->pending_changes);
+	while (g_hash_table_iter_next(&iter, &interface, &props)) {
+		g_variant_builder_init(&vb, G_VARIANT_TYPE("a{sv}"));
+
+		g_hash_table_iter_init(&prop_iter, props);
+		while (g_hash_table_iter_next(&prop_iter, &key, &value))
+			g_variant_builder_add(&vb, "{sv}", key, value);
+
+		prv_emit_properties_changed_now(device, interface,
+						g_variant_builder_end(&vb));
+	}
+
+	g_hash_table_remove_all(device->pending_changes);
+}
+
+static gboolean prv_flush_properties_changed_cb(gpointer user_data)
+{
+	rsu_device_t *device = user_data;
+
+	device->changes_id = 0;
+	prv_flush_properties_changed(device);
+
+	return FALSE;
+}
+
+/* Changes signalled within the same window are merged into a single
+ * PropertiesChanged signal per interface, a later value of a property
+ * replacing an earlier one.  A change of PlaybackStatus is signalled
+ * straight away, along with the changes waiting for the window to end. */
+
+static void prv_emit_signal_properties_changed(rsu_device_t *device,
+					       const char *interface,
+					       GVariant *changed_props)
+{
+	GHashTable *props;
+	GVariantIter iter;
+	gchar *key;
+	GVariant *value;
+	gboolean urgent = FALSE;
+
+	if (!g_variant_n_children(changed_props))
+		return;
+
+	if (!g_properties_changed_window) {
+		prv_emit_properties_changed_now(device, interface,
+						changed_props);
+		return;
+	}
+
+	props = g_hash_table_lookup(device->pending_changes, interface);
+	if (!props) {
+		props = g_hash_table_new_full(g_str_hash, g_str_equal,
+					      g_free, prv_unref_variant);
+		g_hash_table_insert(device->pending_changes,
+				    g_strdup(interface), props);
+	}
+
+	g_variant_iter_init(&iter, changed_props);
+	while (g_variant_iter_next(&iter, "{sv}", &key, &value)) {
+		if (!strcmp(key, RSU_INTERFACE_PROP_PLAYBACK_STATUS))
+			urgent = TRUE;
+		g_hash_table_insert(props, key, value);
 	}
 
-	if (!replaced)
-		g_variant_builder_add(vb, "{sv}", key, value);
+	if (urgent)
+		prv_flush_properties_changed(device);
+	else if (!device->changes_id)
+		device->changes_id = g_timeout_add(
+					g_properties_changed_window,
+					prv_flush_properties_changed_cb,
+					device);
+}
+
+static void prv_emit_signal_seeked(rsu_device_t *device, gint64 position)
+{
+	/* Clients must see the new Position before the Seeked signal */
+
+	prv_flush_properties_changed(device);
+
+	RSU_LOG_DEBUG("Emitted Signal: %s.%s - ObjectPath: %s",
+		      RSU_INTERFACE_PLAYER, RSU_INTERFACE_SEEKED,
+		      device->path);
+
+	g_dbus_connection_emit_signal(device->connection,
+				      NULL,
+				      device->path,
+				      RSU_INTERFACE_PLAYER,
+				      RSU_INTERFACE_SEEKED,
+				      g_variant_new("(x)", position),
+				      NULL);
+}
+
+/* The Metadata of a device is kept as a map of its entries, so that one
+ * of them can be changed in place.  The Metadata property holds its a{sv}
+ * form, built again only after the map changed.  Returns TRUE if the
+ * entry changed.  Sinks value if it is floating. */
+
+static gboolean prv_meta_data_set(GHashTable *meta_data, const gchar *key,
+				  GVariant *value)
+{
+	GVariant *current;
+
+	value = g_variant_ref_sink(value);
+
+	current = g_hash_table_lookup(meta_data, key);
+	if (current && g_variant_equal(current, value)) {
+		g_variant_unref(value);
+		return FALSE;
+	}
+
+	g_hash_table_replace(meta_data, g_strdup(key), value);
+
+	return TRUE;
+}
+
+static void prv_meta_data_changed(rsu_device_t *device,
+				  GVariantBuilder *changed_props_vb)
+{
+	GVariantBuilder vb;
+	GHashTableIter iter;
+	gpointer key;
+	gpointer value;
+
+	g_variant_builder_init(&vb, G_VARIANT_TYPE("a{sv}"));
+	g_hash_table_iter_init(&iter, device->meta_data);
+
+	while (g_hash_table_iter_next(&iter, &key, &value))
+		g_variant_builder_add(&vb, "{sv}", key, value);
 
-	val = g_variant_ref_sink(g_variant_builder_end(vb));
-	prv_change_props(device->props.player_props,
-			 RSU_INTERFACE_PROP_METADATA,
-			 val,
+	prv_change_props(&device->props,
+			 RSU_PROP_METADATA,
+			 g_variant_ref_sink(g_variant_builder_end(&vb)),
 			 changed_props_vb);
-	g_variant_builder_unref(vb);
 }
 
 static void prv_context_new(const gchar *ip_address,
@@ -353,6 +568,7 @@ void rsu_device_delete(void *device)
 {
 	unsigned int i;
 	rsu_device_t *dev = device;
+	GError *error;
 
 	if (dev) {
 		if (dev->timeout_id)
@@ -369,6 +585,27 @@ void rsu_device_delete(void *device)
 		if (dev->transport_play_speeds != NULL)
 			g_ptr_array_free(dev->transport_play_speeds, TRUE);
 		g_free(dev->rate);
+
+		if (dev->position_poll_id)
+			(void) g_source_remove(dev->position_poll_id);
+		if (dev->changes_id)
+			(void) g_source_remove(dev->changes_id);
+		g_hash_table_unref(dev->pending_changes);
+		g_hash_table_unref(dev->meta_data);
+		g_free(dev->meta_data_didl);
+		g_hash_table_unref(dev->position_subscribers);
+		rsu_protocol_info_free(dev->protocol_info);
+
+		if (dev->position_read) {
+			error = g_error_new(RSU_ERROR,
+					    RSU_ERROR_OBJECT_NOT_FOUND,
+					    "Device has been lost.");
+			prv_position_read_abort(dev->position_read, error);
+			g_error_free(error);
+		}
+
+		prv_scpd_forget_device(dev);
+
 		g_free(dev);
 	}
 }
@@ -545,81 +782,37 @@ void rsu_device_subscribe_to_service_changes(rsu_device_t *device)
 	}
 }
 
-static void prv_as_prop_from_hash_table(const gchar *prop_name,
-					GHashTable *values, GHashTable *props)
-{
-	GVariantBuilder vb;
-	GHashTableIter iter;
-	gpointer key;
-	GVariant *val;
-
-	g_variant_builder_init(&vb, G_VARIANT_TYPE("as"));
-	g_hash_table_iter_init(&iter, values);
-
-	while (g_hash_table_iter_next(&iter, &key, NULL))
-		g_variant_builder_add(&vb, "s", key);
-
-	val = g_variant_ref_sink(g_variant_builder_end(&vb));
-	g_hash_table_insert(props, (gchar *)prop_name, val);
-}
-
 static void prv_process_protocol_info(rsu_device_t *device,
 				      const gchar *protocol_info)
 {
 	GVariant *val;
-	gchar **entries;
-	gchar **type_info;
-	unsigned int i;
-	GHashTable *protocols;
-	GHashTable *types;
-	const char http_prefix[] = "http-";
 
 	RSU_LOG_DEBUG("Enter");
 	RSU_LOG_DEBUG("prv_process_protocol_info: %s", protocol_info);
 
-	protocols = g_hash_table_new_full(g_str_hash, g_str_equal, g_free,
-					  NULL);
-	types = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, NULL);
+	/* SinkProtocolInfo is evented with each ConnectionManager change,
+	   usually unchanged */
 
-	val = g_variant_ref_sink(g_variant_new_string(protocol_info));
-	g_hash_table_insert(device->props.device_props,
-			    RSU_INTERFACE_PROP_PROTOCOL_INFO,
-			    val);
-
-	entries = g_strsplit(protocol_info, ",", 0);
-
-	for (i = 0; entries[i]; ++i) {
-		type_info = g_strsplit(entries[i], ":", 0);
-
-		if (type_info[0] && type_info[1] && type_info[2]) {
-			if (!g_ascii_strncasecmp(http_prefix, type_info[0],
-						 sizeof(http_prefix) - 1)) {
-				type_info[0][sizeof(http_prefix) - 2] = 0;
-			}
-
-			g_hash_table_insert(protocols,
-					    g_ascii_strdown(type_info[0], -1),
-					    NULL);
-			g_hash_table_insert(types,
-					    g_ascii_strdown(type_info[2], -1),
-					    NULL);
-		}
+	if (device->protocol_info &&
+	    !strcmp(rsu_protocol_info_get_string(device->protocol_info),
+		    protocol_info))
+		goto exit;
 
-		g_strfreev(type_info);
-	}
+	rsu_protocol_info_free(device->protocol_info);
+	device->protocol_info = rsu_protocol_info_new(protocol_info);
 
-	g_strfreev(entries);
+	val = g_variant_ref_sink(g_variant_new_string(protocol_info));
+	prv_props_set(&device->props, RSU_PROP_PROTOCOL_INFO, val);
 
-	prv_as_prop_from_hash_table(RSU_INTERFACE_PROP_SUPPORTED_URIS,
-				    protocols,
-				    device->props.root_props);
+	val = g_variant_ref_sink(
+		rsu_protocol_info_get_schemes(device->protocol_info));
+	prv_props_set(&device->props, RSU_PROP_SUPPORTED_URIS, val);
 
-	prv_as_prop_from_hash_table(RSU_INTERFACE_PROP_SUPPORTED_MIME,
-				    types,
-				    device->props.root_props);
+	val = g_variant_ref_sink(
+		rsu_protocol_info_get_mime_types(device->protocol_info));
+	prv_props_set(&device->props, RSU_PROP_SUPPORTED_MIME, val);
 
-	g_hash_table_unref(types);
-	g_hash_table_unref(protocols);
+exit:
 
 	RSU_LOG_DEBUG("Exit");
 }
@@ -745,6 +938,15 @@ rsu_device_t *rsu_device_new(GDBusConnection *connection,
 	dev->contexts = g_ptr_array_new_with_free_func(prv_rsu_context_delete);
 	dev->path = new_path;
 	dev->rate = g_strdup("1");
+	dev->volume = G_MAXUINT;
+	dev->position_subscribers = g_hash_table_new_full(g_str_hash,
+							  g_str_equal,
+							  g_free, NULL);
+	dev->meta_data = g_hash_table_new_full(g_str_hash, g_str_equal,
+					       g_free, prv_unref_variant);
+	dev->pending_changes = g_hash_table_new_full(
+					g_str_hash, g_str_equal, g_free,
+					(GDestroyNotify) g_hash_table_unref);
 
 	priv_t->dev = dev;
 	priv_t->interface_info = interface_info;
@@ -756,6 +958,13 @@ rsu_device_t *rsu_device_new(GDBusConnection *connection,
 	context = rsu_device_get_context(dev);
 	s_proxy = context->service_proxies.cm_proxy;
 
+	/* Service descriptions are needed by the first property read */
+
+	if (context->service_proxies.av_proxy)
+		(void) prv_scpd_get(context->service_proxies.av_proxy);
+	if (context->service_proxies.rc_proxy)
+		(void) prv_scpd_get(context->service_proxies.rc_proxy);
+
 	rsu_service_task_add(queue_id, prv_get_protocol_info, dev, s_proxy,
 			     prv_get_protocol_info_cb, NULL, priv_t);
 
@@ -816,36 +1025,35 @@ static void prv_get_prop(rsu_async_task_t *cb_data)
 {
 	rsu_task_get_prop_t *get_prop = &cb_data->task.ut.get_prop;
 	GVariant *res = NULL;
+	rsu_prop_t prop;
+	rsu_prop_t first = RSU_PROP_MAX;
+	rsu_prop_t last = RSU_PROP_MAX;
 
 	RSU_LOG_DEBUG("Enter");
 
+	prop = rsu_prop_from_name(get_prop->prop_name);
+
 	if (!strcmp(get_prop->interface_name, RSU_INTERFACE_RENDERER_DEVICE)) {
-		res = g_hash_table_lookup(cb_data->device->props.device_props,
-					  get_prop->prop_name);
+		first = RSU_PROP_DEVICE_FIRST;
+		last = RSU_PROP_MAX;
 	} else if (!strcmp(get_prop->interface_name, RSU_INTERFACE_SERVER)) {
-		res = g_hash_table_lookup(cb_data->device->props.root_props,
-					  get_prop->prop_name);
+		first = RSU_PROP_ROOT_FIRST;
+		last = RSU_PROP_PLAYER_FIRST;
 	} else if (!strcmp(get_prop->interface_name, RSU_INTERFACE_PLAYER)) {
-		res = g_hash_table_lookup(cb_data->device->props.player_props,
-					  get_prop->prop_name);
+		first = RSU_PROP_PLAYER_FIRST;
+		last = RSU_PROP_DEVICE_FIRST;
 	} else if (!strcmp(get_prop->interface_name, "")) {
-		res = g_hash_table_lookup(cb_data->device->props.root_props,
-					  get_prop->prop_name);
-		if (!res)
-			res = g_hash_table_lookup(
-				cb_data->device->props.player_props,
-				get_prop->prop_name);
-
-		if (!res)
-			res = g_hash_table_lookup(
-				cb_data->device->props.device_props,
-				get_prop->prop_name);
+		first = RSU_PROP_ROOT_FIRST;
+		last = RSU_PROP_MAX;
 	} else {
 		cb_data->error = g_error_new(RSU_ERROR,
 					     RSU_ERROR_UNKNOWN_INTERFACE,
 					     "Unknown Interface");
 	}
 
+	if (!cb_data->error && prop >= first && prop < last)
+		res = cb_data->device->props.values[prop];
+
 	if (!res) {
 		if (!cb_data->error)
 			cb_data->error =
@@ -859,22 +1067,22 @@ static void prv_get_prop(rsu_async_task_t *cb_data)
 	RSU_LOG_DEBUG("Exit");
 }
 
-static void prv_add_props(GHashTable *props, GVariantBuilder *vb)
+static void prv_add_props(rsu_props_t *props, rsu_prop_t first,
+			  rsu_prop_t last, GVariantBuilder *vb)
 {
-	GHashTableIter iter;
-	gpointer key;
-	gpointer value;
-
-	g_hash_table_iter_init(&iter, props);
+	rsu_prop_t prop;
 
-	while (g_hash_table_iter_next(&iter, &key, &value))
-		g_variant_builder_add(vb, "{sv}", (gchar *)key,
-				      (GVariant *)value);
+	for (prop = first; prop < last; ++prop)
+		if (props->values[prop])
+			g_variant_builder_add(vb, "{sv}",
+					      rsu_prop_get_name(prop),
+					      props->values[prop]);
 }
 
 static void prv_get_props(rsu_async_task_t *cb_data)
 {
 	rsu_task_get_props_t *get_props = &cb_data->task.ut.get_props;
+	rsu_props_t *props = &cb_data->device->props;
 	GVariantBuilder *vb;
 
 	RSU_LOG_DEBUG("Enter");
@@ -882,16 +1090,16 @@ static void prv_get_props(rsu_async_task_t *cb_data)
 	vb = g_variant_builder_new(G_VARIANT_TYPE("a{sv}"));
 
 	if (!strcmp(get_props->interface_name, RSU_INTERFACE_RENDERER_DEVICE)) {
-		prv_add_props(cb_data->device->props.device_props, vb);
+		prv_add_props(props, RSU_PROP_DEVICE_FIRST, RSU_PROP_MAX, vb);
 	} else if (!strcmp(get_props->interface_name, RSU_INTERFACE_SERVER)) {
-		prv_add_props(cb_data->device->props.root_props, vb);
-		prv_add_props(cb_data->device->props.device_props, vb);
+		prv_add_props(props, RSU_PROP_ROOT_FIRST,
+			      RSU_PROP_PLAYER_FIRST, vb);
+		prv_add_props(props, RSU_PROP_DEVICE_FIRST, RSU_PROP_MAX, vb);
 	} else if (!strcmp(get_props->interface_name, RSU_INTERFACE_PLAYER)) {
-		prv_add_props(cb_data->device->props.player_props, vb);
+		prv_add_props(props, RSU_PROP_PLAYER_FIRST,
+			      RSU_PROP_DEVICE_FIRST, vb);
 	} else if (!strcmp(get_props->interface_name, "")) {
-		prv_add_props(cb_data->device->props.root_props, vb);
-		prv_add_props(cb_data->device->props.player_props, vb);
-		prv_add_props(cb_data->device->props.device_props, vb);
+		prv_add_props(props, RSU_PROP_ROOT_FIRST, RSU_PROP_MAX, vb);
 	} else {
 		cb_data->error = g_error_new(RSU_ERROR,
 					     RSU_ERROR_UNKNOWN_INTERFACE,
@@ -998,38 +1206,38 @@ static void prv_add_actions(rsu_device_t *device,
 	}
 
 	g_variant_ref(false_val);
-	prv_change_props(device->props.player_props,
-			 RSU_INTERFACE_PROP_CAN_CONTROL, false_val,
+	prv_change_props(&device->props,
+			 RSU_PROP_CAN_CONTROL, false_val,
 			 changed_props_vb);
 
 	val = play ? true_val : false_val;
 	g_variant_ref(val);
-	prv_change_props(device->props.player_props,
-			 RSU_INTERFACE_PROP_CAN_PLAY, val,
+	prv_change_props(&device->props,
+			 RSU_PROP_CAN_PLAY, val,
 			 changed_props_vb);
 
 	val = ppause ? true_val : false_val;
 	g_variant_ref(val);
-	prv_change_props(device->props.player_props,
-			 RSU_INTERFACE_PROP_CAN_PAUSE, val,
+	prv_change_props(&device->props,
+			 RSU_PROP_CAN_PAUSE, val,
 			 changed_props_vb);
 
 	val = seek ? true_val : false_val;
 	g_variant_ref(val);
-	prv_change_props(device->props.player_props,
-			 RSU_INTERFACE_PROP_CAN_SEEK, val,
+	prv_change_props(&device->props,
+			 RSU_PROP_CAN_SEEK, val,
 			 changed_props_vb);
 
 	val = next ? true_val : false_val;
 	g_variant_ref(val);
-	prv_change_props(device->props.player_props,
-			 RSU_INTERFACE_PROP_CAN_NEXT, val,
+	prv_change_props(&device->props,
+			 RSU_PROP_CAN_NEXT, val,
 			 changed_props_vb);
 
 	val = previous ? true_val : false_val;
 	g_variant_ref(val);
-	prv_change_props(device->props.player_props,
-			 RSU_INTERFACE_PROP_CAN_PREVIOUS, val,
+	prv_change_props(&device->props,
+			 RSU_PROP_CAN_PREVIOUS, val,
 			 changed_props_vb);
 
 	g_variant_unref(true_val);
@@ -1043,100 +1251,148 @@ static void prv_add_all_actions(rsu_device_t *device,
 	GVariant *val;
 
 	val = g_variant_ref_sink(g_variant_new_boolean(TRUE));
-	prv_change_props(device->props.player_props,
-			 RSU_INTERFACE_PROP_CAN_PLAY, val,
+	prv_change_props(&device->props,
+			 RSU_PROP_CAN_PLAY, g_variant_ref(val),
 			 changed_props_vb);
-	prv_change_props(device->props.player_props,
-			 RSU_INTERFACE_PROP_CAN_PAUSE, g_variant_ref(val),
+	prv_change_props(&device->props,
+			 RSU_PROP_CAN_PAUSE, g_variant_ref(val),
 			 changed_props_vb);
-	prv_change_props(device->props.player_props,
-			 RSU_INTERFACE_PROP_CAN_SEEK, g_variant_ref(val),
+	prv_change_props(&device->props,
+			 RSU_PROP_CAN_SEEK, g_variant_ref(val),
 			 changed_props_vb);
-	prv_change_props(device->props.player_props,
-			 RSU_INTERFACE_PROP_CAN_NEXT, g_variant_ref(val),
+	prv_change_props(&device->props,
+			 RSU_PROP_CAN_NEXT, g_variant_ref(val),
 			 changed_props_vb);
-	prv_change_props(device->props.player_props,
-			 RSU_INTERFACE_PROP_CAN_PREVIOUS, g_variant_ref(val),
+	prv_change_props(&device->props,
+			 RSU_PROP_CAN_PREVIOUS, g_variant_ref(val),
 			 changed_props_vb);
-	prv_change_props(device->props.player_props,
-			 RSU_INTERFACE_PROP_CAN_CONTROL, g_variant_ref(val),
+	prv_change_props(&device->props,
+			 RSU_PROP_CAN_CONTROL, g_variant_ref(val),
 			 changed_props_vb);
+	g_variant_unref(val);
 }
 
-static gint64 prv_duration_to_int64(const gchar *duration)
+/* Computes the position of the device at the given monotonic time from
+ * the last position it reported.  Returns FALSE if there is no such
+ * position or if something changed on the transport since. */
+
+static gboolean prv_position_extrapolate(rsu_device_t *device, gint64 now,
+					 gint64 *position)
 {
-	gchar **parts;
-	unsigned int i = 0;
-	unsigned int count;
-	gint64 pos = 0;
+	GVariant *status;
+	GVariant *rate;
+	GVariant *length;
+	gint64 elapsed;
+	gint64 pos;
 
-	parts = g_strsplit(duration, ":", 0);
-	for (count = 0; parts[count]; ++count)
-		;
+	if (!device->position_time)
+		return FALSE;
 
-	if (count != 3)
-		goto on_error;
+	status = device->props.values[RSU_PROP_PLAYBACK_STATUS];
+	if (!status)
+		return FALSE;
 
-	/* TODO: This does not handle fractional seconds */
+	elapsed = now - device->position_time;
+	pos = device->position;
 
-	i = 1;
-	do {
-		--count;
-		g_strstrip(parts[count]);
-		pos += atoi(parts[count]) * i;
-		i *= 60;
-	} while (count > 0);
+	if (!strcmp(g_variant_get_string(status, NULL), "Playing")) {
+		rate = device->props.values[RSU_PROP_RATE];
+		if (rate)
+			pos += elapsed * g_variant_get_double(rate);
+		else
+			pos += elapsed;
 
-	pos *= 1000000;
+		pos = MAX(pos, 0);
 
-on_error:
+		length = g_hash_table_lookup(device->meta_data,
+					     "mpris:length");
+		if (length && g_variant_is_of_type(length,
+						   G_VARIANT_TYPE_INT64) &&
+		    g_variant_get_int64(length) > 0)
+			pos = MIN(pos, g_variant_get_int64(length));
+	}
 
-	g_strfreev(parts);
+	*position = pos;
 
-	return pos;
+	return TRUE;
 }
 
-static gchar *prv_int64_to_duration(gint64 micro_seconds)
+/* Returns TRUE if the device seeked since the previous position read */
+
+static gboolean prv_add_reltime(rsu_device_t *device,
+				const gchar *reltime,
+				guint epoch,
+				GVariantBuilder *changed_props_vb)
 {
-	GString *retval;
-	unsigned int seconds;
+	GVariant *val;
+	gint64 pos;
+	gint64 now;
+	gint64 expected;
+	gboolean seeked = FALSE;
 
-	if (micro_seconds < 0) {
-		retval = g_string_new("-");
-		micro_seconds = -micro_seconds;
-	} else {
-		retval = g_string_new("");
+	(void) rsu_duration_parse(reltime, &pos);
+
+	/* A sample read while the transport changed is already outdated */
+
+	if (epoch == device->position_epoch) {
+		now = g_get_monotonic_time();
+
+		seeked = device->position_seeked ||
+			(prv_position_extrapolate(device, now, &expected) &&
+			 ABS(pos - expected) > RSU_DEVICE_SEEK_TOLERANCE);
+
+		device->position_seeked = FALSE;
+		device->position = pos;
+		device->position_time = now;
 	}
 
-	/* TODO: This does not handle fractional seconds */
+	val = g_variant_ref_sink(g_variant_new_int64(pos));
+	prv_change_props(&device->props,
+			 RSU_PROP_POSITION, val,
+			 changed_props_vb);
 
-	seconds = micro_seconds / 1000000;
-	g_string_append_printf(retval, "%02u:%02u:%02u",
-			       seconds / 3600,
-			       (seconds / 60) % 60,
-			       seconds % 60);
+	return seeked;
+}
 
-	return g_string_free(retval, FALSE);
+static void prv_position_invalidate(rsu_device_t *device)
+{
+	device->position_time = 0;
+	device->position_epoch++;
 }
 
-static void prv_add_reltime(rsu_device_t *device,
-			    const gchar *reltime,
-			    GVariantBuilder *changed_props_vb)
+/* Computes the current Position of the device from the last position it
+ * reported, as long as this sample is recent enough and nothing changed
+ * on the transport since.  Returns FALSE if the device must be asked. */
+
+static gboolean prv_position_interpolate(rsu_device_t *device)
 {
-	GVariant *val;
-	gint64 pos = prv_duration_to_int64(reltime);
+	gint64 now;
+	gint64 pos;
 
-	val = g_variant_ref_sink(g_variant_new_int64(pos));
-	prv_change_props(device->props.player_props,
-			 RSU_INTERFACE_PROP_POSITION, val,
-			 changed_props_vb);
+	if (!g_position_resync_interval || !device->position_time)
+		return FALSE;
+
+	now = g_get_monotonic_time();
+	if (now - device->position_time >=
+	    (gint64)g_position_resync_interval * G_USEC_PER_SEC)
+		return FALSE;
+
+	if (!prv_position_extrapolate(device, now, &pos))
+		return FALSE;
+
+	prv_change_props(&device->props,
+			 RSU_PROP_POSITION,
+			 g_variant_ref_sink(g_variant_new_int64(pos)),
+			 NULL);
+
+	return TRUE;
 }
 
 static void prv_found_item(GUPnPDIDLLiteParser *parser,
 			   GUPnPDIDLLiteObject *object,
 			   gpointer user_data)
 {
-	GVariantBuilder *vb = user_data;
+	GHashTable *meta_data = user_data;
 	gchar *track_id;
 	int track_number = gupnp_didl_lite_object_get_track_number(object);
 	GVariant *value;
@@ -1152,36 +1408,36 @@ static void prv_found_item(GUPnPDIDLLiteParser *parser,
 				   track_number != -1 ? track_number : 0);
 
 	value = g_variant_new_string(track_id);
-	g_variant_builder_add(vb, "{sv}", "mpris:trackid", value);
+	(void) prv_meta_data_set(meta_data, "mpris:trackid", value);
 	g_free(track_id);
 
 	if (track_number != -1) {
 		value = g_variant_new_int32(track_number);
-		g_variant_builder_add(vb, "{sv}", "mpris:trackNumber", value);
+		(void) prv_meta_data_set(meta_data, "mpris:trackNumber", value);
 	}
 
 	str_value = gupnp_didl_lite_object_get_title(object);
 	if (str_value) {
 		value = g_variant_new_string(str_value);
-		g_variant_builder_add(vb, "{sv}", "xesam:title", value);
+		(void) prv_meta_data_set(meta_data, "xesam:title", value);
 	}
 
 	str_value = gupnp_didl_lite_object_get_album_art(object);
 	if (str_value) {
 		value = g_variant_new_string(str_value);
-		g_variant_builder_add(vb, "{sv}", "mpris:artUrl", value);
+		(void) prv_meta_data_set(meta_data, "mpris:artUrl", value);
 	}
 
 	str_value = gupnp_didl_lite_object_get_album(object);
 	if (str_value) {
 		value = g_variant_new_string(str_value);
-		g_variant_builder_add(vb, "{sv}", "xesam:album", value);
+		(void) prv_meta_data_set(meta_data, "xesam:album", value);
 	}
 
 	str_value = gupnp_didl_lite_object_get_genre(object);
 	if (str_value) {
 		value = g_variant_new_string(str_value);
-		g_variant_builder_add(vb, "{sv}", "xesam:genre", value);
+		(void) prv_meta_data_set(meta_data, "xesam:genre", value);
 	}
 
 	artists = gupnp_didl_lite_object_get_artists(object);
@@ -1207,63 +1463,176 @@ static void prv_found_item(GUPnPDIDLLiteParser *parser,
 		} while (artists);
 		g_list_free(head);
 		value = g_variant_builder_end(artists_vb);
-		g_variant_builder_add(vb, "{sv}", "xesam:artist", value);
+		(void) prv_meta_data_set(meta_data, "xesam:artist", value);
 		value = g_variant_builder_end(album_artists_vb);
-		g_variant_builder_add(vb, "{sv}", "xesam:albumArtist", value);
+		(void) prv_meta_data_set(meta_data, "xesam:albumArtist", value);
 		g_variant_builder_unref(artists_vb);
 		g_variant_builder_unref(album_artists_vb);
 	}
 }
 
+static void prv_meta_data_cache_entry_free(gpointer data)
+{
+	prv_meta_data_cache_entry_t *entry = data;
+
+	g_free(entry->didl);
+	g_hash_table_unref(entry->meta_data);
+	g_free(entry);
+}
+
+/* Returns the entries found in the DIDL-Lite of a CurrentTrackMetaData,
+ * owned by the cache, or NULL if it cannot be parsed.  The least recently
+ * used entry is dropped when the cache is full. */
+
+static GHashTable *prv_meta_data_parse(const gchar *metadata)
+{
+	prv_meta_data_cache_entry_t *entry;
+	GHashTable *meta_data = NULL;
+	GError *upnp_error = NULL;
+	gchar *didl = NULL;
+	gulong handler;
+	gint error_code;
+
+	if (!g_meta_data_cache) {
+		g_meta_data_cache = g_hash_table_new_full(
+					g_str_hash, g_str_equal, NULL,
+					prv_meta_data_cache_entry_free);
+		g_didl_parser = gupnp_didl_lite_parser_new();
+	}
+
+	entry = g_hash_table_lookup(g_meta_data_cache, metadata);
+	if (entry) {
+		g_queue_unlink(&g_meta_data_lru, &entry->link);
+		g_queue_push_head_link(&g_meta_data_lru, &entry->link);
+		return entry->meta_data;
+	}
+
+	didl = g_strdup_printf("<DIDL-Lite>%s</DIDL-Lite>", metadata);
+	meta_data = g_hash_table_new_full(g_str_hash, g_str_equal, g_free,
+					  prv_unref_variant);
+
+	handler = g_signal_connect(g_didl_parser, "object-available",
+				   G_CALLBACK(prv_found_item), meta_data);
+
+	if (!gupnp_didl_lite_parser_parse_didl(g_didl_parser, didl,
+					       &upnp_error)) {
+		error_code = upnp_error->code;
+		g_error_free(upnp_error);
+		if (error_code != GUPNP_XML_ERROR_EMPTY_NODE) {
+			g_hash_table_unref(meta_data);
+			meta_data = NULL;
+		}
+	}
+
+	g_signal_handler_disconnect(g_didl_parser, handler);
+	g_free(didl);
+
+	if (!meta_data)
+		goto on_error;
+
+	if (g_queue_get_length(&g_meta_data_lru) >=
+	    RSU_DEVICE_META_DATA_CACHE_SIZE) {
+		entry = g_queue_peek_tail_link(&g_meta_data_lru)->data;
+		g_queue_unlink(&g_meta_data_lru, &entry->link);
+		(void) g_hash_table_remove(g_meta_data_cache, entry->didl);
+	}
+
+	entry = g_new0(prv_meta_data_cache_entry_t, 1);
+	entry->didl = g_strdup(metadata);
+	entry->meta_data = meta_data;
+	entry->link.data = entry;
+	g_hash_table_insert(g_meta_data_cache, entry->didl, entry);
+	g_queue_push_head_link(&g_meta_data_lru, &entry->link);
+
+on_error:
+
+	return meta_data;
+}
+
 static void prv_add_track_meta_data(rsu_device_t *device,
 				    const gchar *metadata,
 				    const gchar *duration,
 				    const gchar *uri,
 				    GVariantBuilder *changed_props_vb)
 {
-	gchar *didl = g_strdup_printf("<DIDL-Lite>%s</DIDL-Lite>", metadata);
-	GUPnPDIDLLiteParser *parser = NULL;
-	GVariantBuilder *vb;
-	GError *upnp_error = NULL;
+	GHashTable *parsed;
+	GHashTable *meta_data;
+	GHashTableIter iter;
+	gpointer key;
+	gpointer value;
 	GVariant *val;
-	gint error_code;
-
-	parser = gupnp_didl_lite_parser_new();
-
-	vb = g_variant_builder_new(G_VARIANT_TYPE("a{sv}"));
+	gint64 length;
+	gboolean changed = FALSE;
+
+	/* The entries of the track are only copied from the cache when the
+	   track changed.  Events repeating the current track only update
+	   its duration and URI in place, and nothing at all if those did
+	   not change either. */
+
+	if (metadata && g_strcmp0(metadata, device->meta_data_didl)) {
+		parsed = prv_meta_data_parse(metadata);
+		if (!parsed)
+			return;
+
+		meta_data = g_hash_table_new_full(g_str_hash, g_str_equal,
+						  g_free, prv_unref_variant);
+
+		g_hash_table_iter_init(&iter, parsed);
+		while (g_hash_table_iter_next(&iter, &key, &value))
+			g_hash_table_insert(meta_data, g_strdup(key),
+					    g_variant_ref(value));
+
+		g_hash_table_unref(device->meta_data);
+		device->meta_data = meta_data;
+		g_free(device->meta_data_didl);
+		device->meta_data_didl = g_strdup(metadata);
+		changed = TRUE;
+	}
 
 	if (duration) {
-		val = g_variant_new_int64(prv_duration_to_int64(duration));
-		g_variant_builder_add(vb, "{sv}", "mpris:length", val);
+		(void) rsu_duration_parse(duration, &length);
+		val = g_variant_new_int64(length);
+		if (prv_meta_data_set(device->meta_data, "mpris:length", val))
+			changed = TRUE;
 	}
 
 	if (uri) {
 		val = g_variant_new_string(uri);
-		g_variant_builder_add(vb, "{sv}", "xesam:url", val);
+		if (prv_meta_data_set(device->meta_data, "xesam:url", val))
+			changed = TRUE;
 	}
 
-	g_signal_connect(parser, "object-available" ,
-			 G_CALLBACK(prv_found_item), vb);
+	if (changed)
+		prv_meta_data_changed(device, changed_props_vb);
+}
 
-	if (!gupnp_didl_lite_parser_parse_didl(parser, didl, &upnp_error)) {
-		error_code = upnp_error->code;
-		g_error_free(upnp_error);
-		if (error_code != GUPNP_XML_ERROR_EMPTY_NODE)
-			goto on_error;
-	}
+/* Variables of the AVTransport LastChange events, read in this order */
+static const gchar * const g_av_last_change_names[] = {
+	"CurrentTrackMetaData",
+	"CurrentTransportActions",
+	"TransportPlaySpeed",
+	"TransportState",
+	"CurrentTrackDuration",
+	"CurrentTrackURI",
+	"NumberOfTracks",
+	"CurrentTrack"
+};
 
-	prv_change_props(device->props.player_props,
-			 RSU_INTERFACE_PROP_METADATA,
-			 g_variant_ref_sink(g_variant_builder_end(vb)),
-			 changed_props_vb);
+/* Sets value to the unsigned number in str, if it is one, and frees str */
 
-on_error:
+static void prv_last_change_uint(gchar *str, guint *value)
+{
+	guint64 number;
+	gchar *end;
 
-	if (parser)
-		g_object_unref(parser);
+	if (!str)
+		return;
 
-	g_variant_builder_unref(vb);
-	g_free(didl);
+	number = g_ascii_strtoull(str, &end, 10);
+	if (*str && !*end && number <= G_MAXUINT)
+		*value = number;
+
+	g_free(str);
 }
 
 static void prv_last_change_cb(GUPnPServiceProxy *proxy,
@@ -1271,68 +1640,57 @@ static void prv_last_change_cb(GUPnPServiceProxy *proxy,
 			       GValue *value,
 			       gpointer user_data)
 {
-	GUPnPLastChangeParser *parser;
 	rsu_device_t *device = user_data;
 	GVariantBuilder *changed_props_vb;
 	GVariant *changed_props;
-	gchar *meta_data = NULL;
-	gchar *actions = NULL;
-	gchar *play_speed = NULL;
-	gchar *state = NULL;
-	gchar *duration = NULL;
-	gchar *uri = NULL;
+	gchar *values[G_N_ELEMENTS(g_av_last_change_names)];
+	gchar *meta_data;
+	gchar *actions;
+	gchar *play_speed;
+	gchar *state;
+	gchar *duration;
+	gchar *uri;
 	guint tracks_number = G_MAXUINT;
 	guint current_track = G_MAXUINT;
 	GVariant *val;
+	GVariant *current_uri;
+	gboolean transport_changed;
+
+	if (!rsu_last_change_parse(g_value_get_string(value), 0,
+				   g_av_last_change_names, values,
+				   G_N_ELEMENTS(g_av_last_change_names)))
+		return;
+
+	meta_data = values[0];
+	actions = values[1];
+	play_speed = values[2];
+	state = values[3];
+	duration = values[4];
+	uri = values[5];
+	prv_last_change_uint(values[6], &tracks_number);
+	prv_last_change_uint(values[7], &current_track);
+
+	/* The position last read is not a reference anymore once the
+	   track, the state or the rate of the transport changed.  Renderers
+	   often resend them unchanged, which leaves the position alone. */
+
+	transport_changed = meta_data &&
+		g_strcmp0(meta_data, device->meta_data_didl);
 
-	parser = gupnp_last_change_parser_new();
-
-	if (!gupnp_last_change_parser_parse_last_change(
-		    parser, 0,
-		    g_value_get_string(value),
-		    NULL,
-		    "CurrentTrackMetaData", G_TYPE_STRING, &meta_data,
-		    "CurrentTransportActions", G_TYPE_STRING, &actions,
-		    "TransportPlaySpeed", G_TYPE_STRING, &play_speed,
-		    "TransportState", G_TYPE_STRING, &state,
-		    "CurrentTrackDuration", G_TYPE_STRING, &duration,
-		    "CurrentTrackURI", G_TYPE_STRING, &uri,
-		    "NumberOfTracks", G_TYPE_UINT, &tracks_number,
-		    "CurrentTrack", G_TYPE_UINT, &current_track,
-		    NULL))
-		goto on_error;
+	if (uri) {
+		current_uri = g_hash_table_lookup(device->meta_data,
+						  "xesam:url");
+		if (!current_uri ||
+		    strcmp(g_variant_get_string(current_uri, NULL), uri))
+			transport_changed = TRUE;
+	}
 
 	changed_props_vb = g_variant_builder_new(G_VARIANT_TYPE("a{sv}"));
 
-	if (meta_data) {
-		prv_add_track_meta_data(device,
-					meta_data,
-					duration,
-					uri,
-					changed_props_vb);
-		g_free(meta_data);
-	} else {
-		if (duration) {
-			val = g_variant_new_int64(prv_duration_to_int64(
-							  duration));
-			val = g_variant_ref_sink(val);
-			prv_merge_meta_data(device,
-					    "mpris:length",
-					    val,
-					    changed_props_vb);
-			g_variant_unref(val);
-		}
-
-		if (uri) {
-			val = g_variant_ref_sink(g_variant_new_string(uri));
-			prv_merge_meta_data(device,
-					    "xesam:url",
-					    val,
-					    changed_props_vb);
-			g_variant_unref(val);
-		}
-	}
+	prv_add_track_meta_data(device, meta_data, duration, uri,
+				changed_props_vb);
 
+	g_free(meta_data);
 	g_free(duration);
 	g_free(uri);
 
@@ -1345,9 +1703,10 @@ static void prv_last_change_cb(GUPnPServiceProxy *proxy,
 		val = g_variant_ref_sink(
 			g_variant_new_double(
 				prv_map_transport_speed(play_speed)));
-		prv_change_props(device->props.player_props,
-				 RSU_INTERFACE_PROP_RATE, val,
-				 changed_props_vb);
+		if (prv_change_props(&device->props,
+				     RSU_PROP_RATE, val,
+				     changed_props_vb))
+			transport_changed = TRUE;
 
 		g_free(device->rate);
 		device->rate = play_speed;
@@ -1357,26 +1716,31 @@ static void prv_last_change_cb(GUPnPServiceProxy *proxy,
 		val = g_variant_ref_sink(
 			g_variant_new_string(
 				prv_map_transport_state(state)));
-		prv_change_props(device->props.player_props,
-				 RSU_INTERFACE_PROP_PLAYBACK_STATUS, val,
-				 changed_props_vb);
+		if (prv_change_props(&device->props,
+				     RSU_PROP_PLAYBACK_STATUS, val,
+				     changed_props_vb))
+			transport_changed = TRUE;
 		g_free(state);
 	}
 
 	if (tracks_number != G_MAXUINT) {
 		val = g_variant_ref_sink(g_variant_new_uint32(tracks_number));
-		prv_change_props(device->props.player_props,
-				  RSU_INTERFACE_PROP_NUMBER_OF_TRACKS, val,
+		prv_change_props(&device->props,
+				  RSU_PROP_NUMBER_OF_TRACKS, val,
 				  changed_props_vb);
 	}
 
 	if (current_track != G_MAXUINT) {
 		val = g_variant_ref_sink(g_variant_new_uint32(current_track));
-		prv_change_props(device->props.player_props,
-				  RSU_INTERFACE_PROP_CURRENT_TRACK, val,
-				  changed_props_vb);
+		if (prv_change_props(&device->props,
+				     RSU_PROP_CURRENT_TRACK, val,
+				     changed_props_vb))
+			transport_changed = TRUE;
 	}
 
+	if (transport_changed)
+		prv_position_invalidate(device);
+
 	changed_props = g_variant_ref_sink(
 				g_variant_builder_end(changed_props_vb));
 	prv_emit_signal_properties_changed(device,
@@ -1384,10 +1748,26 @@ static void prv_last_change_cb(GUPnPServiceProxy *proxy,
 					   changed_props);
 	g_variant_unref(changed_props);
 	g_variant_builder_unref(changed_props_vb);
+}
 
-on_error:
+/* The Volume of a device can only be computed once the maximum volume
+ * is read from its RenderingControl description.  Volume events received
+ * before are kept in device->volume until then. */
+
+static void prv_volume_changed(rsu_device_t *device,
+			       GVariantBuilder *changed_props_vb)
+{
+	GVariant *val;
+	double mpris_volume;
+
+	if (device->max_volume == 0 || device->volume == G_MAXUINT)
+		return;
 
-	g_object_unref(parser);
+	mpris_volume = (double)device->volume / (double)device->max_volume;
+	val = g_variant_ref_sink(g_variant_new_double(mpris_volume));
+	prv_change_props(&device->props,
+			 RSU_PROP_VOLUME, val,
+			 changed_props_vb);
 }
 
 static void prv_rc_last_change_cb(GUPnPServiceProxy *proxy,
@@ -1395,37 +1775,24 @@ static void prv_rc_last_change_cb(GUPnPServiceProxy *proxy,
 			       GValue *value,
 			       gpointer user_data)
 {
-	GUPnPLastChangeParser *parser;
+	static const gchar * const names[] = { "Volume" };
 	rsu_device_t *device = user_data;
 	GVariantBuilder *changed_props_vb;
 	GVariant *changed_props;
-	GVariant *val;
-	guint device_volume;
-	double mpris_volume;
+	gchar *volume;
 
-	parser = gupnp_last_change_parser_new();
+	if (!rsu_last_change_parse(g_value_get_string(value), 0, names,
+				   &volume, G_N_ELEMENTS(names)))
+		return;
 
-	if (!gupnp_last_change_parser_parse_last_change(
-		    parser, 0,
-		    g_value_get_string(value),
-		    NULL,
-		    "Volume", G_TYPE_UINT, &device_volume,
-		    NULL))
-		goto on_error;
+	prv_last_change_uint(volume, &device->volume);
 
 	if (device->props.synced == FALSE)
 		prv_props_update(device, NULL);
 
-	if (device->max_volume == 0)
-		goto on_error;
-
 	changed_props_vb = g_variant_builder_new(G_VARIANT_TYPE("a{sv}"));
 
-	mpris_volume = (double)device_volume / (double)device->max_volume;
-	val = g_variant_ref_sink(g_variant_new_double(mpris_volume));
-	prv_change_props(device->props.player_props,
-			 RSU_INTERFACE_PROP_VOLUME, val,
-			 changed_props_vb);
+	prv_volume_changed(device, changed_props_vb);
 
 	changed_props = g_variant_ref_sink(
 				g_variant_builder_end(changed_props_vb));
@@ -1434,10 +1801,6 @@ static void prv_rc_last_change_cb(GUPnPServiceProxy *proxy,
 					   changed_props);
 	g_variant_unref(changed_props);
 	g_variant_builder_unref(changed_props_vb);
-
-on_error:
-
-	g_object_unref(parser);
 }
 
 static void prv_sink_change_cb(GUPnPServiceProxy *proxy,
@@ -1454,25 +1817,46 @@ static void prv_sink_change_cb(GUPnPServiceProxy *proxy,
 		prv_process_protocol_info(device, sink);
 }
 
+static void prv_position_read_free(rsu_device_position_read_t *read)
+{
+	if (read->device->position_read == read)
+		read->device->position_read = NULL;
+
+	if (read->proxy != NULL)
+		g_object_remove_weak_pointer((G_OBJECT(read->proxy)),
+					     (gpointer *)&read->proxy);
+
+	g_ptr_array_unref(read->waiters);
+	g_free(read);
+}
+
 static void prv_get_position_info_cb(GUPnPServiceProxy *proxy,
 				     GUPnPServiceProxyAction *action,
 				     gpointer user_data)
 {
 	gchar *rel_pos = NULL;
-	rsu_async_task_t *cb_data = user_data;
+	rsu_device_position_read_t *read = user_data;
+	rsu_async_task_t *cb_data;
+	GError *error = NULL;
 	GError *upnp_error = NULL;
-	rsu_device_data_t *device_data = cb_data->private;
+	rsu_device_data_t *device_data;
 	GVariantBuilder *changed_props_vb;
 	GVariant *changed_props;
+	gboolean seeked;
+	guint i;
 
-	if (!gupnp_service_proxy_end_action(cb_data->proxy, cb_data->action,
+	/* New Position reads issued from now on need a new action */
+
+	read->device->position_read = NULL;
+
+	if (!gupnp_service_proxy_end_action(read->proxy, read->action,
 					    &upnp_error,
 					    "RelTime",
 					    G_TYPE_STRING, &rel_pos, NULL)) {
-		cb_data->error = g_error_new(RSU_ERROR,
-					     RSU_ERROR_OPERATION_FAILED,
-					     "GetPositionInfo operation "
-					     "failed: %s", upnp_error->message);
+		error = g_error_new(RSU_ERROR,
+				    RSU_ERROR_OPERATION_FAILED,
+				    "GetPositionInfo operation "
+				    "failed: %s", upnp_error->message);
 		g_error_free(upnp_error);
 
 		goto on_error;
@@ -1481,42 +1865,246 @@ static void prv_get_position_info_cb(GUPnPServiceProxy *proxy,
 	changed_props_vb = g_variant_builder_new(G_VARIANT_TYPE("a{sv}"));
 
 	g_strstrip(rel_pos);
-	prv_add_reltime(cb_data->device, rel_pos, changed_props_vb);
+	seeked = prv_add_reltime(read->device, rel_pos, read->epoch,
+				 changed_props_vb);
 	g_free(rel_pos);
 
 	changed_props = g_variant_ref_sink(
 				g_variant_builder_end(changed_props_vb));
-	prv_emit_signal_properties_changed(cb_data->device,
+	prv_emit_signal_properties_changed(read->device,
 					   RSU_INTERFACE_PLAYER,
 					   changed_props);
 	g_variant_unref(changed_props);
 	g_variant_builder_unref(changed_props_vb);
 
+	if (seeked)
+		prv_emit_signal_seeked(read->device, read->device->position);
+
 on_error:
 
-	device_data->local_cb(cb_data);
+	for (i = 0; i < read->waiters->len; ++i) {
+		cb_data = g_ptr_array_index(read->waiters, i);
+		device_data = cb_data->private;
+
+		if (error)
+			cb_data->error = g_error_copy(error);
+
+		device_data->local_cb(cb_data);
+	}
+
+	if (error)
+		g_error_free(error);
+
+	prv_position_read_free(read);
 }
 
-static void prv_get_position_info(rsu_async_task_t *cb_data)
+static void prv_get_position_info_cancelled(GCancellable *cancellable,
+					    gpointer user_data)
+{
+	rsu_async_task_t *cb_data = user_data;
+	rsu_device_position_read_t *read = cb_data->device->position_read;
+
+	/* Only this waiter goes away.  The action itself is cancelled once
+	   nobody, not even the position poller, is waiting for its result
+	   anymore. */
+
+	if (read && g_ptr_array_remove_fast(read->waiters, cb_data)) {
+		if (read->waiters->len == 0 && !read->polled) {
+			if (read->proxy)
+				gupnp_service_proxy_cancel_action(read->proxy,
+								  read->action);
+			prv_position_read_free(read);
+		}
+	}
+
+	if (!cb_data->error)
+		cb_data->error = g_error_new(RSU_ERROR, RSU_ERROR_CANCELLED,
+					     "Operation cancelled.");
+	rsu_async_task_defer_complete(cb_data);
+}
+
+static void prv_position_read_abort(rsu_device_position_read_t *read,
+				    const GError *error)
+{
+	rsu_async_task_t *cb_data;
+	guint i;
+
+	if (read->proxy)
+		gupnp_service_proxy_cancel_action(read->proxy, read->action);
+
+	for (i = 0; i < read->waiters->len; ++i) {
+		cb_data = g_ptr_array_index(read->waiters, i);
+		g_cancellable_disconnect(cb_data->cancellable,
+					 cb_data->cancel_id);
+
+		if (!cb_data->error)
+			cb_data->error = g_error_copy(error);
+		rsu_async_task_defer_complete(cb_data);
+	}
+
+	prv_position_read_free(read);
+}
+
+static rsu_device_position_read_t *prv_position_read_begin(
+							rsu_device_t *device)
 {
+	rsu_device_position_read_t *read = device->position_read;
 	rsu_device_context_t *context;
 
-	context = rsu_device_get_context(cb_data->device);
+	if (!read) {
+		context = rsu_device_get_context(device);
+
+		read = g_new0(rsu_device_position_read_t, 1);
+		read->device = device;
+		read->waiters = g_ptr_array_new();
+		read->epoch = device->position_epoch;
+		read->started = g_get_monotonic_time();
+		read->proxy = context->service_proxies.av_proxy;
+		g_object_add_weak_pointer((G_OBJECT(read->proxy)),
+					  (gpointer *)&read->proxy);
+		read->action =
+			gupnp_service_proxy_begin_action(
+						read->proxy,
+						"GetPositionInfo",
+						prv_get_position_info_cb,
+						read,
+						"InstanceID", G_TYPE_INT, 0,
+						NULL);
+		device->position_read = read;
+	} else {
+		RSU_LOG_DEBUG("Joining GetPositionInfo in progress");
+	}
 
-	cb_data->cancel_id =
-		g_cancellable_connect(cb_data->cancellable,
-				      G_CALLBACK(rsu_async_task_cancelled),
-				      cb_data, NULL);
-	cb_data->proxy = context->service_proxies.av_proxy;
-	g_object_add_weak_pointer((G_OBJECT(context->service_proxies.av_proxy)),
-				  (gpointer *)&cb_data->proxy);
-	cb_data->action =
-		gupnp_service_proxy_begin_action(cb_data->proxy,
-						 "GetPositionInfo",
-						 prv_get_position_info_cb,
-						 cb_data,
-						 "InstanceID", G_TYPE_INT, 0,
-						 NULL);
+	return read;
+}
+
+static void prv_get_position_info(rsu_async_task_t *cb_data)
+{
+	rsu_device_position_read_t *read;
+
+	read = prv_position_read_begin(cb_data->device);
+	g_ptr_array_add(read->waiters, cb_data);
+
+	cb_data->cancel_id = g_cancellable_connect(
+				cb_data->cancellable,
+				G_CALLBACK(prv_get_position_info_cancelled),
+				cb_data, NULL);
+}
+
+/* The poller stops waiting for read, which is cancelled if no client
+ * waits for it either */
+
+static void prv_position_read_release(rsu_device_position_read_t *read)
+{
+	read->polled = FALSE;
+
+	if (read->waiters->len == 0) {
+		if (read->proxy)
+			gupnp_service_proxy_cancel_action(read->proxy,
+							  read->action);
+		prv_position_read_free(read);
+	}
+}
+
+static gboolean prv_position_poll_cb(gpointer user_data)
+{
+	rsu_device_t *device = user_data;
+	rsu_device_position_read_t *read = device->position_read;
+	gint64 deadline;
+
+	/* The poller stops waiting for a read the renderer does not answer,
+	   so that it does not keep it alive forever.  The reads of clients
+	   waiting for it are left alone, and fail on their task timeout. */
+
+	if (read && read->polled) {
+		if (g_position_read_timeout)
+			deadline = (gint64)g_position_read_timeout *
+				G_USEC_PER_SEC;
+		else
+			deadline = (gint64)device->position_poll_interval *
+				1000 * RSU_DEVICE_POSITION_READ_POLLS;
+
+		if (g_get_monotonic_time() - read->started >= deadline) {
+			RSU_LOG_DEBUG("Giving up GetPositionInfo on %s",
+				      device->path);
+
+			read->abandoned = TRUE;
+			prv_position_read_release(read);
+		}
+	}
+
+	/* Polling resumes once the clients are done with an abandoned read.
+	   A read still in progress is not doubled.  Its result is emitted
+	   like the one of a new read would have been. */
+
+	read = device->position_read;
+	if (read && read->abandoned)
+		return TRUE;
+
+	read = prv_position_read_begin(device);
+	read->polled = TRUE;
+
+	return TRUE;
+}
+
+/* Polls the device at the shortest interval asked by its subscribers,
+ * and stops polling once none is left */
+
+static void prv_position_poll_update(rsu_device_t *device)
+{
+	rsu_device_position_read_t *read;
+	GHashTableIter iter;
+	gpointer value;
+	guint interval = G_MAXUINT;
+
+	g_hash_table_iter_init(&iter, device->position_subscribers);
+	while (g_hash_table_iter_next(&iter, NULL, &value))
+		interval = MIN(interval, GPOINTER_TO_UINT(value));
+
+	if (interval == G_MAXUINT)
+		interval = 0;
+
+	if (interval == device->position_poll_interval)
+		return;
+
+	if (device->position_poll_id)
+		(void) g_source_remove(device->position_poll_id);
+
+	device->position_poll_id = 0;
+	device->position_poll_interval = interval;
+
+	/* A read in progress is no longer kept alive by the poller once
+	   the last subscriber has gone */
+
+	read = device->position_read;
+	if (!interval && read && read->polled)
+		prv_position_read_release(read);
+
+	if (interval) {
+		RSU_LOG_DEBUG("Polling position of %s every %u ms",
+			      device->path, interval);
+
+		device->position_poll_id = g_timeout_add(interval,
+							 prv_position_poll_cb,
+							 device);
+	}
+}
+
+void rsu_device_subscribe_position(rsu_device_t *device, const gchar *client,
+				   guint interval)
+{
+	interval = MAX(interval, RSU_DEVICE_POSITION_MIN_INTERVAL);
+
+	g_hash_table_insert(device->position_subscribers, g_strdup(client),
+			    GUINT_TO_POINTER(interval));
+	prv_position_poll_update(device);
+}
+
+void rsu_device_unsubscribe_position(rsu_device_t *device,
+				     const gchar *client)
+{
+	if (g_hash_table_remove(device->position_subscribers, client))
+		prv_position_poll_update(device);
 }
 
 /***********************************************************************/
@@ -1581,7 +2169,29 @@ static gint prv_compare_rationals(const gchar *a, const gchar *b)
 	return (a_numerator * b_denominator) - (b_numerator * a_denominator);
 }
 
-static void prv_get_rates_values(const GUPnPServiceStateVariableInfo *svi,
+/* Allowed TransportPlaySpeed values, as UPnP rationals */
+
+static GPtrArray *prv_get_allowed_rates(
+				const GUPnPServiceStateVariableInfo *svi)
+{
+	GPtrArray *rates;
+	GList *list;
+
+	rates = g_ptr_array_new_with_free_func(g_free);
+
+	if ((svi == NULL) || (svi->allowed_values == NULL))
+		goto exit;
+
+	for (list = svi->allowed_values; list != NULL; list = list->next)
+		if (!prv_rational_is_invalid(list->data))
+			g_ptr_array_add(rates, g_strdup(list->data));
+
+exit:
+
+	return rates;
+}
+
+static void prv_get_rates_values(GPtrArray *rates,
 				 GVariant **mpris_tp_speeds,
 				 GPtrArray **upnp_tp_speeds,
 				 double *min_rate, double *max_rate)
@@ -1589,18 +2199,16 @@ static void prv_get_rates_values(const GUPnPServiceStateVariableInfo *svi,
 	char *rate;
 	char *min_rate_str;
 	char *max_rate_str;
-	GList *list;
 	GVariantBuilder vb;
 	const double precision = 0.01;
+	guint i;
 
-	if ((svi == NULL) || (svi->allowed_values == NULL))
+	if (rates->len == 0)
 		goto exit;
 
 	g_variant_builder_init(&vb, G_VARIANT_TYPE("ad"));
 
-	list = svi->allowed_values;
-
-	min_rate_str = list->data;
+	min_rate_str = g_ptr_array_index(rates, 0);
 	max_rate_str = min_rate_str;
 
 	if (*upnp_tp_speeds != NULL)
@@ -1608,11 +2216,8 @@ static void prv_get_rates_values(const GUPnPServiceStateVariableInfo *svi,
 
 	*upnp_tp_speeds = g_ptr_array_new_with_free_func(g_free);
 
-	for (; list != NULL; list = list->next) {
-		rate = (char *)list->data;
-
-		if (prv_rational_is_invalid(rate))
-			continue;
+	for (i = 0; i < rates->len; ++i) {
+		rate = g_ptr_array_index(rates, i);
 
 		g_ptr_array_add(*upnp_tp_speeds, g_strdup(rate));
 
@@ -1634,23 +2239,82 @@ exit:
 	return;
 }
 
-static void prv_get_av_service_states_values(GUPnPServiceProxy *av_proxy,
-					     GVariant **mpris_tp_speeds,
-					     GPtrArray **upnp_tp_speeds,
-					     double *min_rate,
-					     double *max_rate)
+static void prv_scpd_free(gpointer data)
+{
+	prv_scpd_t *scpd = data;
+
+	g_free(scpd->url);
+	if (scpd->rates)
+		g_ptr_array_unref(scpd->rates);
+	g_ptr_array_unref(scpd->waiters);
+	g_free(scpd);
+}
+
+static void prv_scpd_apply(rsu_device_t *device, prv_scpd_t *scpd,
+			   GVariantBuilder *changed_props_vb)
+{
+	GVariant *val;
+	double min_rate = 0;
+	double max_rate = 0;
+	GVariant *mpris_transport_play_speeds = NULL;
+
+	if (scpd->rates)
+		prv_get_rates_values(scpd->rates,
+				     &mpris_transport_play_speeds,
+				     &device->transport_play_speeds,
+				     &min_rate,
+				     &max_rate);
+
+	if (min_rate != 0) {
+		val = g_variant_ref_sink(g_variant_new_double(min_rate));
+		prv_change_props(&device->props,
+				 RSU_PROP_MINIMUM_RATE, val,
+				 changed_props_vb);
+	}
+
+	if (max_rate != 0) {
+		val = g_variant_ref_sink(g_variant_new_double(max_rate));
+		prv_change_props(&device->props,
+				 RSU_PROP_MAXIMUM_RATE,
+				 val, changed_props_vb);
+	}
+
+	if (mpris_transport_play_speeds != NULL) {
+		val = g_variant_ref_sink(mpris_transport_play_speeds);
+		prv_change_props(&device->props,
+				 RSU_PROP_TRANSPORT_PLAY_SPEEDS,
+				 val, changed_props_vb);
+	}
+
+	if (scpd->max_volume) {
+		device->max_volume = scpd->max_volume;
+		prv_volume_changed(device, changed_props_vb);
+	}
+}
+
+static void prv_scpd_cb(GUPnPServiceInfo *info,
+			GUPnPServiceIntrospection *introspection,
+			const GError *error,
+			gpointer user_data)
 {
+	prv_scpd_t *scpd = user_data;
 	const GUPnPServiceStateVariableInfo *svi;
-	GUPnPServiceIntrospection *introspection;
-	GError *error = NULL;
+	GVariantBuilder *changed_props_vb;
+	GVariant *changed_props;
+	rsu_device_t *device;
+	guint i;
+
+	g_object_unref(scpd->proxy);
+	scpd->proxy = NULL;
 
-	introspection =	gupnp_service_info_get_introspection(
-						GUPNP_SERVICE_INFO(av_proxy),
-						&error);
 	if (error != NULL) {
-		RSU_LOG_DEBUG("failed to fetch AV service introspection file");
+		RSU_LOG_DEBUG("failed to fetch service introspection file %s",
+			      scpd->url);
 
-		g_error_free(error);
+		/* The next device to ask for it will try again */
+
+		g_hash_table_steal(g_scpd_cache, scpd->url);
+		prv_scpd_free(scpd);
 
 		goto exit;
 	}
@@ -1658,105 +2322,167 @@ static void prv_get_av_service_states_values(GUPnPServiceProxy *av_proxy,
 	svi = gupnp_service_introspection_get_state_variable(
 							introspection,
 							"TransportPlaySpeed");
+	if (svi != NULL)
+		scpd->rates = prv_get_allowed_rates(svi);
 
-	prv_get_rates_values(svi,
-			     mpris_tp_speeds, upnp_tp_speeds,
-			     min_rate, max_rate);
+	svi = gupnp_service_introspection_get_state_variable(introspection,
+							     "Volume");
+	if (svi != NULL)
+		scpd->max_volume = g_value_get_uint(&svi->maximum);
 
 	g_object_unref(introspection);
 
+	scpd->fetched = TRUE;
+
+	for (i = 0; i < scpd->waiters->len; ++i) {
+		device = g_ptr_array_index(scpd->waiters, i);
+		changed_props_vb = g_variant_builder_new(
+						G_VARIANT_TYPE("a{sv}"));
+
+		prv_scpd_apply(device, scpd, changed_props_vb);
+
+		changed_props = g_variant_ref_sink(
+				g_variant_builder_end(changed_props_vb));
+		prv_emit_signal_properties_changed(device,
+						   RSU_INTERFACE_PLAYER,
+						   changed_props);
+		g_variant_unref(changed_props);
+		g_variant_builder_unref(changed_props_vb);
+	}
+
+	g_ptr_array_set_size(scpd->waiters, 0);
+
 exit:
 
 	return;
 }
 
-static void prv_get_rc_service_states_values(GUPnPServiceProxy *rc_proxy,
-					     guint *max_volume)
+/* Returns the description of the service of proxy, whose values are only
+ * set once fetched is TRUE, or NULL if the service has none.  Starts
+ * fetching it if needed. */
+
+static prv_scpd_t *prv_scpd_get(GUPnPServiceProxy *proxy)
 {
-	const GUPnPServiceStateVariableInfo *svi;
-	GUPnPServiceIntrospection *introspection;
-	GError *error = NULL;
+	prv_scpd_t *scpd;
+	gchar *url;
 
-	introspection =	gupnp_service_info_get_introspection(
-						GUPNP_SERVICE_INFO(rc_proxy),
-						&error);
-	if (error != NULL) {
-		RSU_LOG_DEBUG("failed to fetch RC service introspection file");
+	if (!g_scpd_cache)
+		g_scpd_cache = g_hash_table_new_full(g_str_hash, g_str_equal,
+						     NULL, prv_scpd_free);
 
-		g_error_free(error);
+	url = gupnp_service_info_get_scpd_url(GUPNP_SERVICE_INFO(proxy));
+	if (!url)
+		return NULL;
 
+	scpd = g_hash_table_lookup(g_scpd_cache, url);
+	if (scpd) {
+		g_free(url);
 		goto exit;
 	}
 
-	svi = gupnp_service_introspection_get_state_variable(introspection,
-							     "Volume");
-	if (svi != NULL)
-		*max_volume = g_value_get_uint(&svi->maximum);
+	scpd = g_new0(prv_scpd_t, 1);
+	scpd->url = url;
+	scpd->waiters = g_ptr_array_new();
+	scpd->proxy = g_object_ref(proxy);
+	g_hash_table_insert(g_scpd_cache, scpd->url, scpd);
 
-	g_object_unref(introspection);
+	gupnp_service_info_get_introspection_async(GUPNP_SERVICE_INFO(proxy),
+						   prv_scpd_cb, scpd);
 
 exit:
 
-	return;
+	return scpd;
 }
 
-static void prv_update_device_props(GUPnPDeviceInfo *proxy, GHashTable *props)
+/* Applies the description of the service of proxy to the device, or does
+ * so once it is fetched */
+
+static void prv_scpd_update(rsu_device_t *device, GUPnPServiceProxy *proxy,
+			    GVariantBuilder *changed_props_vb)
+{
+	prv_scpd_t *scpd = prv_scpd_get(proxy);
+
+	if (!scpd)
+		return;
+
+	if (scpd->fetched)
+		prv_scpd_apply(device, scpd, changed_props_vb);
+	else
+		g_ptr_array_add(scpd->waiters, device);
+}
+
+static void prv_scpd_forget_device(rsu_device_t *device)
+{
+	GHashTableIter iter;
+	gpointer value;
+
+	if (!g_scpd_cache)
+		return;
+
+	g_hash_table_iter_init(&iter, g_scpd_cache);
+
+	while (g_hash_table_iter_next(&iter, NULL, &value))
+		(void) g_ptr_array_remove(((prv_scpd_t *)value)->waiters,
+					  device);
+}
+
+static void prv_update_device_props(GUPnPDeviceInfo *proxy, rsu_props_t *props)
 {
 	GVariant *val;
 	gchar *str;
 
 	val = g_variant_ref_sink(g_variant_new_string(
 				gupnp_device_info_get_device_type(proxy)));
-	g_hash_table_insert(props, RSU_INTERFACE_PROP_DEVICE_TYPE, val);
+	prv_props_set(props, RSU_PROP_DEVICE_TYPE, val);
 
 	val = g_variant_ref_sink(g_variant_new_string(
 					gupnp_device_info_get_udn(proxy)));
-	g_hash_table_insert(props, RSU_INTERFACE_PROP_UDN, val);
+	prv_props_set(props, RSU_PROP_UDN, val);
 
 	str = gupnp_device_info_get_friendly_name(proxy);
 	val = g_variant_ref_sink(g_variant_new_string(str));
-	g_hash_table_insert(props, RSU_INTERFACE_PROP_FRIENDLY_NAME, val);
+	prv_props_set(props, RSU_PROP_FRIENDLY_NAME, val);
 	g_free(str);
 
 	str = gupnp_device_info_get_icon_url(proxy, NULL, -1, -1, -1, FALSE,
 					     NULL, NULL, NULL, NULL);
 	val = g_variant_ref_sink(g_variant_new_string(str));
-	g_hash_table_insert(props, RSU_INTERFACE_PROP_ICON_URL, val);
+	prv_props_set(props, RSU_PROP_ICON_URL, val);
 	g_free(str);
 
 	str = gupnp_device_info_get_manufacturer(proxy);
 	val = g_variant_ref_sink(g_variant_new_string(str));
-	g_hash_table_insert(props, RSU_INTERFACE_PROP_MANUFACTURER, val);
+	prv_props_set(props, RSU_PROP_MANUFACTURER, val);
 	g_free(str);
 
 	str = gupnp_device_info_get_manufacturer_url(proxy);
 	val = g_variant_ref_sink(g_variant_new_string(str));
-	g_hash_table_insert(props, RSU_INTERFACE_PROP_MANUFACTURER_URL, val);
+	prv_props_set(props, RSU_PROP_MANUFACTURER_URL, val);
 	g_free(str);
 
 	str = gupnp_device_info_get_model_description(proxy);
 	val = g_variant_ref_sink(g_variant_new_string(str));
-	g_hash_table_insert(props, RSU_INTERFACE_PROP_MODEL_DESCRIPTION, val);
+	prv_props_set(props, RSU_PROP_MODEL_DESCRIPTION, val);
 	g_free(str);
 
 	str = gupnp_device_info_get_model_name(proxy);
 	val = g_variant_ref_sink(g_variant_new_string(str));
-	g_hash_table_insert(props, RSU_INTERFACE_PROP_MODEL_NAME, val);
+	prv_props_set(props, RSU_PROP_MODEL_NAME, val);
 	g_free(str);
 
 	str = gupnp_device_info_get_model_number(proxy);
 	val = g_variant_ref_sink(g_variant_new_string(str));
-	g_hash_table_insert(props, RSU_INTERFACE_PROP_MODEL_NUMBER, val);
+	prv_props_set(props, RSU_PROP_MODEL_NUMBER, val);
 	g_free(str);
 
 	str = gupnp_device_info_get_serial_number(proxy);
 	val = g_variant_ref_sink(g_variant_new_string(str));
-	g_hash_table_insert(props, RSU_INTERFACE_PROP_SERIAL_NUMBER, val);
+	prv_props_set(props, RSU_PROP_SERIAL_NUMBER, val);
 	g_free(str);
 
 	str = gupnp_device_info_get_presentation_url(proxy);
 	val = g_variant_ref_sink(g_variant_new_string(str));
-	g_hash_table_insert(props, RSU_INTERFACE_PROP_PRESENTATION_URL, val);
+	prv_props_set(props, RSU_PROP_PRESENTATION_URL, val);
 	g_free(str);
 
 }
@@ -1770,71 +2496,33 @@ static void prv_props_update(rsu_device_t *device, rsu_task_t *task)
 	rsu_props_t *props = &device->props;
 	GVariantBuilder *changed_props_vb;
 	GVariant *changed_props;
-	double min_rate = 0;
-	double max_rate = 0;
-	GVariant *mpris_transport_play_speeds = NULL;
 
 	context = rsu_device_get_context(device);
 
 	val = g_variant_ref_sink(g_variant_new_boolean(FALSE));
-	g_hash_table_insert(props->root_props, RSU_INTERFACE_PROP_CAN_QUIT,
-			    val);
-
-	g_hash_table_insert(props->root_props, RSU_INTERFACE_PROP_CAN_RAISE,
-			    g_variant_ref(val));
-
-	g_hash_table_insert(props->root_props,
-			    RSU_INTERFACE_PROP_CAN_SET_FULLSCREEN,
-			    g_variant_ref(val));
-
-	g_hash_table_insert(props->root_props,
-			    RSU_INTERFACE_PROP_HAS_TRACK_LIST,
-			    g_variant_ref(val));
+	prv_props_set(props, RSU_PROP_CAN_QUIT, val);
+	prv_props_set(props, RSU_PROP_CAN_RAISE, g_variant_ref(val));
+	prv_props_set(props, RSU_PROP_CAN_SET_FULLSCREEN, g_variant_ref(val));
+	prv_props_set(props, RSU_PROP_HAS_TRACK_LIST, g_variant_ref(val));
 
 	info = (GUPnPDeviceInfo *)context->device_proxy;
 
-	prv_update_device_props(info, props->device_props);
+	prv_update_device_props(info, props);
 
-	val = g_hash_table_lookup(props->device_props,
-			    RSU_INTERFACE_PROP_FRIENDLY_NAME);
-	g_hash_table_insert(props->root_props, RSU_INTERFACE_PROP_IDENTITY,
-			    g_variant_ref(val));
+	val = props->values[RSU_PROP_FRIENDLY_NAME];
+	prv_props_set(props, RSU_PROP_IDENTITY, g_variant_ref(val));
 
 	changed_props_vb = g_variant_builder_new(G_VARIANT_TYPE("a{sv}"));
 
 	service_proxies = &context->service_proxies;
 
 	if (service_proxies->av_proxy)
-		prv_get_av_service_states_values(service_proxies->av_proxy,
-						 &mpris_transport_play_speeds,
-						 &device->transport_play_speeds,
-						 &min_rate,
-						 &max_rate);
+		prv_scpd_update(device, service_proxies->av_proxy,
+				changed_props_vb);
 
 	if (service_proxies->rc_proxy)
-		prv_get_rc_service_states_values(service_proxies->rc_proxy,
-						 &device->max_volume);
-
-	if (min_rate != 0) {
-		val = g_variant_ref_sink(g_variant_new_double(min_rate));
-		prv_change_props(device->props.player_props,
-				 RSU_INTERFACE_PROP_MINIMUM_RATE, val,
-				 changed_props_vb);
-	}
-
-	if (max_rate != 0) {
-		val = g_variant_ref_sink(g_variant_new_double(max_rate));
-		prv_change_props(device->props.player_props,
-				 RSU_INTERFACE_PROP_MAXIMUM_RATE,
-				 val, changed_props_vb);
-	}
-
-	if (mpris_transport_play_speeds != NULL) {
-		val = g_variant_ref_sink(mpris_transport_play_speeds);
-		prv_change_props(device->props.player_props,
-				 RSU_INTERFACE_PROP_TRANSPORT_PLAY_SPEEDS,
-				 val, changed_props_vb);
-	}
+		prv_scpd_update(device, service_proxies->rc_proxy,
+				changed_props_vb);
 
 	prv_add_all_actions(device, changed_props_vb);
 	device->props.synced = TRUE;
@@ -1851,14 +2539,14 @@ static void prv_props_update(rsu_device_t *device, rsu_task_t *task)
 static void prv_complete_get_prop(rsu_async_task_t *cb_data)
 {
 	prv_get_prop(cb_data);
-	(void) g_idle_add(rsu_async_task_complete, cb_data);
+	rsu_async_task_defer_complete(cb_data);
 	g_cancellable_disconnect(cb_data->cancellable, cb_data->cancel_id);
 }
 
 static void prv_complete_get_props(rsu_async_task_t *cb_data)
 {
 	prv_get_props(cb_data);
-	(void) g_idle_add(rsu_async_task_complete, cb_data);
+	rsu_async_task_defer_complete(cb_data);
 	g_cancellable_disconnect(cb_data->cancellable, cb_data->cancel_id);
 }
 
@@ -1878,7 +2566,15 @@ static void prv_simple_call_cb(GUPnPServiceProxy *proxy,
 		g_error_free(upnp_error);
 	}
 
-	(void) g_idle_add(rsu_async_task_complete, cb_data);
+	/* Transport commands may move the playback position */
+
+	prv_position_invalidate(cb_data->device);
+
+	if (!cb_data->error && (cb_data->task.type == RSU_TASK_SEEK ||
+				cb_data->task.type == RSU_TASK_SET_POSITION))
+		cb_data->device->position_seeked = TRUE;
+
+	rsu_async_task_defer_complete(cb_data);
 	g_cancellable_disconnect(cb_data->cancellable, cb_data->cancel_id);
 }
 
@@ -1914,8 +2610,7 @@ static GVariant *prv_get_rate_value_from_double(GVariant *params,
 	GPtrArray *upnp_tp_speeds;
 	int i;
 
-	tps = g_hash_table_lookup(cb_data->device->props.player_props,
-				  RSU_INTERFACE_PROP_TRANSPORT_PLAY_SPEEDS);
+	tps = cb_data->device->props.values[RSU_PROP_TRANSPORT_PLAY_SPEEDS];
 
 	if (tps == NULL) {
 		cb_data->error = g_error_new(RSU_ERROR,
@@ -1979,8 +2674,9 @@ static void prv_set_rate(GVariant *params, rsu_async_task_t *cb_data)
 
 	RSU_LOG_INFO("Set device rate to %s", cb_data->device->rate);
 
-	prv_change_props(cb_data->device->props.player_props,
-			 RSU_INTERFACE_PROP_RATE, val, NULL);
+	prv_change_props(&cb_data->device->props,
+			 RSU_PROP_RATE, val, NULL);
+	prv_position_invalidate(cb_data->device);
 
 exit:
 
@@ -2035,7 +2731,7 @@ void rsu_device_set_prop(rsu_device_t *device, rsu_task_t *task,
 
 exit:
 
-	g_idle_add(rsu_async_task_complete, cb_data);
+	rsu_async_task_defer_complete(cb_data);
 }
 
 void rsu_device_get_prop(rsu_device_t *device, rsu_task_t *task,
@@ -2046,13 +2742,15 @@ void rsu_device_get_prop(rsu_device_t *device, rsu_task_t *task,
 	rsu_device_data_t *device_cb_data;
 
 	/* Need to check to see if the property is RSU_INTERFACE_PROP_POSITION.
-	   If it is we need to call GetPositionInfo.  This value is not evented.
+	   If it is we need to call GetPositionInfo, unless it can be computed
+	   from the last position read.  This value is not evented.
 	   Otherwise we can just update the value straight away. */
 
 	if ((!strcmp(get_prop->interface_name, RSU_INTERFACE_PLAYER) ||
 	     !strcmp(get_prop->interface_name, "")) &&
 	    (!strcmp(task->ut.get_prop.prop_name,
-			RSU_INTERFACE_PROP_POSITION))) {
+			RSU_INTERFACE_PROP_POSITION)) &&
+	    !prv_position_interpolate(device)) {
 		/* Need to read the current position.  This property is not
 		   evented */
 
@@ -2073,7 +2771,7 @@ void rsu_device_get_prop(rsu_device_t *device, rsu_task_t *task,
 			prv_props_update(device, task);
 
 		prv_get_prop(cb_data);
-		(void) g_idle_add(rsu_async_task_complete, cb_data);
+		rsu_async_task_defer_complete(cb_data);
 	}
 }
 
@@ -2088,7 +2786,8 @@ void rsu_device_get_all_props(rsu_device_t *device, rsu_task_t *task,
 		prv_props_update(device, task);
 
 	if ((!strcmp(get_props->interface_name, RSU_INTERFACE_PLAYER) ||
-	     !strcmp(get_props->interface_name, ""))) {
+	     !strcmp(get_props->interface_name, "")) &&
+	    !prv_position_interpolate(device)) {
 
 		/* Need to read the current position.  This property is not
 		   evented */
@@ -2107,8 +2806,72 @@ void rsu_device_get_all_props(rsu_device_t *device, rsu_task_t *task,
 		cb_data->device = device;
 
 		prv_get_props(cb_data);
-		(void) g_idle_add(rsu_async_task_complete, cb_data);
+		rsu_async_task_defer_complete(cb_data);
+	}
+}
+
+/* Position is not evented, so reading it needs a GetPositionInfo action.
+ * Any other property is read from the cache. */
+
+gboolean rsu_device_is_cached_read(rsu_task_t *task)
+{
+	const gchar *interface_name;
+	gboolean player;
+
+	if (task->type == RSU_TASK_GET_PROP)
+		interface_name = task->ut.get_prop.interface_name;
+	else if (task->type == RSU_TASK_GET_ALL_PROPS)
+		interface_name = task->ut.get_props.interface_name;
+	else
+		return FALSE;
+
+	player = !strcmp(interface_name, RSU_INTERFACE_PLAYER) ||
+		!strcmp(interface_name, "");
+
+	if (task->type == RSU_TASK_GET_ALL_PROPS)
+		return !player;
+
+	return !player || strcmp(task->ut.get_prop.prop_name,
+				 RSU_INTERFACE_PROP_POSITION);
+}
+
+void rsu_device_set_position_resync_interval(guint seconds)
+{
+	g_position_resync_interval = seconds;
+}
+
+void rsu_device_set_position_read_timeout(guint seconds)
+{
+	g_position_read_timeout = seconds;
+}
+
+void rsu_device_set_properties_changed_window(guint window)
+{
+	g_properties_changed_window = window;
+}
+
+gboolean rsu_device_get_cached_props(rsu_device_t *device, rsu_task_t *task,
+				     GError **error)
+{
+	rsu_async_task_t *cb_data = (rsu_async_task_t *)task;
+
+	cb_data->device = device;
+
+	if (!device->props.synced)
+		prv_props_update(device, task);
+
+	if (task->type == RSU_TASK_GET_PROP)
+		prv_get_prop(cb_data);
+	else
+		prv_get_props(cb_data);
+
+	if (cb_data->error) {
+		g_propagate_error(error, cb_data->error);
+		cb_data->error = NULL;
+		return FALSE;
 	}
+
+	return TRUE;
 }
 
 void rsu_device_play(rsu_device_t *device, rsu_task_t *task,
@@ -2145,8 +2908,7 @@ void rsu_device_play_pause(rsu_device_t *device, rsu_task_t *task,
 {
 	GVariant *state;
 
-	state = g_hash_table_lookup(device->props.player_props,
-				    RSU_INTERFACE_PROP_PLAYBACK_STATUS);
+	state = device->props.values[RSU_PROP_PLAYBACK_STATUS];
 
 	if (state && !strcmp(g_variant_get_string(state, NULL), "Playing"))
 		rsu_device_pause(device, task, cb);
@@ -2220,6 +2982,17 @@ void rsu_device_open_uri(rsu_device_t *device, rsu_task_t *task,
 	cb_data->cb = cb;
 	cb_data->device = device;
 
+	if (device->protocol_info &&
+	    !rsu_protocol_info_accepts_uri(device->protocol_info,
+					   open_uri_data->uri)) {
+		cb_data->error = g_error_new(RSU_ERROR,
+					     RSU_ERROR_NOT_SUPPORTED,
+					     "URI scheme not supported by "
+					     "the renderer");
+		rsu_async_task_defer_complete(cb_data);
+		return;
+	}
+
 	cb_data->cancel_id =
 		g_cancellable_connect(cb_data->cancellable,
 				      G_CALLBACK(rsu_async_task_cancelled),
@@ -2247,16 +3020,17 @@ static void prv_device_set_position(rsu_device_t *device, rsu_task_t *task,
 	rsu_device_context_t *context;
 	rsu_async_task_t *cb_data = (rsu_async_task_t *)task;
 	rsu_task_seek_t *seek_data = &task->ut.seek;
-	gchar *position;
+	gchar position[RSU_DURATION_SIZE];
 
 	context = rsu_device_get_context(device);
 	cb_data->cb = cb;
 	cb_data->device = device;
 
 	if (!strcmp(pos_type, "TRACK_NR"))
-		position = g_strdup_printf("%u", seek_data->track_number);
+		g_snprintf(position, sizeof(position), "%u",
+			   seek_data->track_number);
 	else
-		position = prv_int64_to_duration(seek_data->position);
+		rsu_duration_format(seek_data->position, position);
 
 	RSU_LOG_INFO("set %s position : %s", pos_type, position);
 
@@ -2279,8 +3053,6 @@ static void prv_device_set_position(rsu_device_t *device, rsu_task_t *task,
 						 "Target",
 						 G_TYPE_STRING, position,
 						 NULL);
-
-	g_free(position);
 }
 
 void rsu_device_seek(rsu_device_t *device, rsu_task_t *task,
@@ -2308,13 +3080,26 @@ void rsu_device_host_uri(rsu_device_t *device, rsu_task_t *task,
 	rsu_device_context_t *context;
 	rsu_async_task_t *cb_data = (rsu_async_task_t *)task;
 	rsu_task_host_uri_t *host_uri = &task->ut.host_uri;
-	gchar *url;
+	gchar *url = NULL;
+	gchar *mime_type;
 	GError *error = NULL;
 
+	/* Files the renderer cannot fetch over HTTP are not hosted */
+
+	mime_type = rsu_host_service_get_mime_type(host_uri->uri);
+	if (mime_type && device->protocol_info &&
+	    !rsu_protocol_info_accepts_type(device->protocol_info,
+					    "http-get", mime_type, NULL))
+		error = g_error_new(RSU_ERROR, RSU_ERROR_BAD_MIME,
+				    "MIME Type %s not supported by the "
+				    "renderer", mime_type);
+	g_free(mime_type);
+
 	context = rsu_device_get_context(device);
-	url = rsu_host_service_add(host_service, context->ip_address,
-				   host_uri->client, host_uri->uri,
-				   &error);
+	if (!error)
+		url = rsu_host_service_add(host_service, context->ip_address,
+					   host_uri->client, host_uri->uri,
+					   &error);
 
 	cb_data->cb = cb;
 	cb_data->device = device;
@@ -2326,7 +3111,7 @@ void rsu_device_host_uri(rsu_device_t *device, rsu_task_t *task,
 		cb_data->error  = error;
 	}
 
-	(void) g_idle_add(rsu_async_task_complete, cb_data);
+	rsu_async_task_defer_complete(cb_data);
 }
 
 void rsu_device_remove_uri(rsu_device_t *device, rsu_task_t *task,
@@ -2349,5 +3134,5 @@ void rsu_device_remove_uri(rsu_device_t *device, rsu_task_t *task,
 					     " device");
 	}
 
-	(void) g_idle_add(rsu_async_task_complete, cb_data);
+	rsu_async_task_defer_complete(cb_data);
 }
@@ -30,6 +30,8 @@
 #include <libgupnp/gupnp-device-proxy.h>
 
 #include "host-service.h"
+#include "props.h"
+#include "protocol-info.h"
 #include "upnp.h"
 #include "renderer-service-upnp.h"
 
@@ -56,12 +58,12 @@ struct rsu_device_context_t_ {
 
 typedef struct rsu_props_t_ rsu_props_t;
 struct rsu_props_t_ {
-	GHashTable *root_props;
-	GHashTable *player_props;
-	GHashTable *device_props;
+	GVariant *values[RSU_PROP_MAX];
 	gboolean synced;
 };
 
+typedef struct rsu_device_position_read_t_ rsu_device_position_read_t;
+
 struct rsu_device_t_ {
 	GDBusConnection *connection;
 	guint ids[RSU_INTERFACE_INFO_MAX];
@@ -70,8 +72,22 @@ struct rsu_device_t_ {
 	rsu_props_t props;
 	guint timeout_id;
 	guint max_volume;
+	guint volume;
 	GPtrArray *transport_play_speeds;
 	gchar *rate;
+	rsu_device_position_read_t *position_read;
+	gint64 position;
+	gint64 position_time;
+	guint position_epoch;
+	gboolean position_seeked;
+	GHashTable *position_subscribers;
+	guint position_poll_id;
+	guint position_poll_interval;
+	GHashTable *pending_changes;
+	guint changes_id;
+	GHashTable *meta_data;
+	gchar *meta_data_didl;
+	rsu_protocol_info_t *protocol_info;
 };
 
 rsu_device_t *rsu_device_new(GDBusConnection *connection,
@@ -98,6 +114,16 @@ void rsu_device_get_prop(rsu_device_t *device, rsu_task_t *task,
 			rsu_upnp_task_complete_t cb);
 void rsu_device_get_all_props(rsu_device_t *device, rsu_task_t *task,
 			      rsu_upnp_task_complete_t cb);
+gboolean rsu_device_is_cached_read(rsu_task_t *task);
+gboolean rsu_device_get_cached_props(rsu_device_t *device, rsu_task_t *task,
+				     GError **error);
+void rsu_device_set_position_resync_interval(guint seconds);
+void rsu_device_set_position_read_timeout(guint seconds);
+void rsu_device_set_properties_changed_window(guint window);
+void rsu_device_subscribe_position(rsu_device_t *device, const gchar *client,
+				   guint interval);
+void rsu_device_unsubscribe_position(rsu_device_t *device,
+				     const gchar *client);
 void rsu_device_play(rsu_device_t *device, rsu_task_t *task,
 		     rsu_upnp_task_complete_t cb);
 void rsu_device_pause(rsu_device_t *device, rsu_task_t *task,
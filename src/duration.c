@@ -0,0 +1,180 @@
+/*
+ * renderer-service-upnp
+ *
+ * Copyright (C) 2013 Intel Corporation. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU Lesser General Public License,
+ * version 2.1, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St - Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ */
+
+
+#include "duration.h"
+
+/* Longest F0 and F1 of a F0/F1 fraction.  Below 19 digits, ten times a
+ * remainder of the division of F0 by F1 still fits in a guint64. */
+#define RSU_DURATION_MAX_DIGITS 18
+
+/* Reads the decimal number at p, of at most max_digits digits, and moves
+ * p past it.  Returns FALSE if there is no such number. */
+
+static gboolean prv_duration_number(const gchar **p, guint max_digits,
+				    guint64 *number)
+{
+	const gchar *start = *p;
+
+	*number = 0;
+
+	while (g_ascii_isdigit(**p)) {
+		if (*p - start == max_digits)
+			return FALSE;
+
+		*number = *number * 10 + **p - '0';
+		++*p;
+	}
+
+	return *p > start;
+}
+
+/* Reads the fraction of a second at p, past its '.', in microseconds.
+ * Only the first six digits of a F+ fraction are significant, but it may
+ * have any number of them.  A F0/F1 fraction is divided digit by digit,
+ * so that only remainders, lower than F1, are multiplied by ten. */
+
+static gboolean prv_duration_fraction(const gchar **p, guint64 *fraction)
+{
+	const gchar *start = *p;
+	guint64 number;
+	guint64 denominator;
+	guint64 scale = G_USEC_PER_SEC;
+
+	*fraction = 0;
+
+	while (g_ascii_isdigit(**p)) {
+		scale /= 10;
+		*fraction += (**p - '0') * scale;
+		++*p;
+	}
+
+	if (*p == start)
+		return FALSE;
+
+	if (**p != '/')
+		return TRUE;
+
+	*p = start;
+
+	if (!prv_duration_number(p, RSU_DURATION_MAX_DIGITS, &number) ||
+	    *(*p)++ != '/' ||
+	    !prv_duration_number(p, RSU_DURATION_MAX_DIGITS, &denominator) ||
+	    number >= denominator)
+		return FALSE;
+
+	*fraction = 0;
+
+	for (scale = 1; scale < G_USEC_PER_SEC; scale *= 10) {
+		number *= 10;
+		*fraction = *fraction * 10 + number / denominator;
+		number %= denominator;
+	}
+
+	return TRUE;
+}
+
+gboolean rsu_duration_parse(const gchar *duration, gint64 *micro_seconds)
+{
+	const gchar *p = duration;
+	gboolean negative = FALSE;
+	guint64 hours;
+	guint64 minutes;
+	guint64 seconds;
+	guint64 fraction = 0;
+
+	*micro_seconds = 0;
+
+	while (g_ascii_isspace(*p))
+		++p;
+
+	if (*p == '+' || *p == '-')
+		negative = *p++ == '-';
+
+	if (!prv_duration_number(&p, RSU_DURATION_MAX_DIGITS, &hours) ||
+	    *p++ != ':' ||
+	    !prv_duration_number(&p, 2, &minutes) || *p++ != ':' ||
+	    !prv_duration_number(&p, 2, &seconds) ||
+	    minutes >= 60 || seconds >= 60)
+		return FALSE;
+
+	if (*p == '.') {
+		++p;
+		if (!prv_duration_fraction(&p, &fraction))
+			return FALSE;
+	}
+
+	while (g_ascii_isspace(*p))
+		++p;
+
+	if (*p)
+		return FALSE;
+
+	if (hours > G_MAXINT64 / G_USEC_PER_SEC / 3600)
+		return FALSE;
+
+	seconds += (hours * 60 + minutes) * 60;
+
+	if (seconds > (G_MAXINT64 - fraction) / G_USEC_PER_SEC)
+		return FALSE;
+
+	*micro_seconds = seconds * G_USEC_PER_SEC + fraction;
+
+	if (negative)
+		*micro_seconds = -*micro_seconds;
+
+	return TRUE;
+}
+
+const gchar *rsu_duration_format(gint64 micro_seconds, gchar *buffer)
+{
+	const gchar *sign = "";
+	guint64 seconds;
+	guint fraction;
+	gint digits = 6;
+	gint len;
+
+	if (micro_seconds < 0) {
+		sign = "-";
+		seconds = -(guint64)micro_seconds;
+	} else {
+		seconds = micro_seconds;
+	}
+
+	fraction = seconds % G_USEC_PER_SEC;
+	seconds /= G_USEC_PER_SEC;
+
+	len = g_snprintf(buffer, RSU_DURATION_SIZE,
+			 "%s%02"G_GUINT64_FORMAT":%02u:%02u", sign,
+			 seconds / 3600, (guint)(seconds / 60 % 60),
+			 (guint)(seconds % 60));
+
+	if (fraction) {
+		while (!(fraction % 10)) {
+			fraction /= 10;
+			--digits;
+		}
+
+		g_snprintf(buffer + len, RSU_DURATION_SIZE - len,
+			   ".%0*u", digits, fraction);
+	}
+
+	return buffer;
+}
@@ -0,0 +1,43 @@
+/*
+ * renderer-service-upnp
+ *
+ * Copyright (C) 2013 Intel Corporation. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU Lesser General Public License,
+ * version 2.1, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St - Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ */
+
+
+#ifndef RSU_DURATION_H__
+#define RSU_DURATION_H__
+
+#include <glib.h>
+
+/* Size of the longest duration written, -H+:MM:SS.FFFFFF */
+#define RSU_DURATION_SIZE 40
+
+/* Converts a UPnP duration, [+|-]H+:MM:SS[.F+|.F0/F1], to microseconds.
+ * Returns FALSE, and sets micro_seconds to 0, if duration does not follow
+ * this grammar, which is the case of NOT_IMPLEMENTED, or does not fit in
+ * a gint64. */
+
+gboolean rsu_duration_parse(const gchar *duration, gint64 *micro_seconds);
+
+/* Writes micro_seconds as a UPnP duration in buffer, of RSU_DURATION_SIZE
+ * bytes, which is returned.  The fraction of a second is only written if
+ * there is one, without its trailing zeros. */
+
+const gchar *rsu_duration_format(gint64 micro_seconds, gchar *buffer);
+
+#endif /* RSU_DURATION_H__ */
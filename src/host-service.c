@@ -431,6 +431,21 @@ on_error:
 	return NULL;
 }
 
+gchar *rsu_host_service_get_mime_type(const gchar *file)
+{
+	gchar *content_type;
+	gchar *mime_type = NULL;
+
+	content_type = g_content_type_guess(file, NULL, 0, NULL);
+
+	if (content_type) {
+		mime_type = g_content_type_get_mime_type(content_type);
+		g_free(content_type);
+	}
+
+	return mime_type;
+}
+
 gchar *rsu_host_service_add(rsu_host_service_t *host_service,
 			    const gchar *device_if, const gchar *client,
 			    const gchar *file, GError **error)
@@ -26,6 +26,7 @@
 typedef struct rsu_host_service_t_ rsu_host_service_t;
 
 void rsu_host_service_new(rsu_host_service_t **host_service);
+gchar *rsu_host_service_get_mime_type(const gchar *file);
 gchar *rsu_host_service_add(rsu_host_service_t *host_service,
 			    const gchar *device_if, const gchar *client,
 			    const gchar *file, GError **error);
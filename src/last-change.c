@@ -0,0 +1,398 @@
+/*
+ * renderer-service-upnp
+ *
+ * Copyright (C) 2013 Intel Corporation. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU Lesser General Public License,
+ * version 2.1, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St - Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ */
+
+
+#include <string.h>
+
+#include <libgupnp-av/gupnp-av.h>
+
+#include "last-change.h"
+
+/* LastChange events are small documents of a fixed shape:
+ *
+ * <Event xmlns="...">
+ *   <InstanceID val="0">
+ *     <TransportState val="PLAYING"/>
+ *     <Volume channel="Master" val="40"/>
+ *   </InstanceID>
+ * </Event>
+ *
+ * They are scanned in a single pass, without building a document tree.
+ * Only the values of the variables asked for are copied, and their
+ * entities are decoded in place.  Comments, text, CDATA sections or any
+ * other construct the scanner does not expect make it give up, and the
+ * event is then handed to the generic GUPnP parser. */
+
+#define RSU_LAST_CHANGE_EVENT "Event"
+#define RSU_LAST_CHANGE_INSTANCE "InstanceID"
+#define RSU_LAST_CHANGE_MASTER "Master"
+
+typedef struct prv_element_t_ prv_element_t;
+struct prv_element_t_ {
+	const gchar *name;
+	gsize name_len;
+	const gchar *val;
+	gsize val_len;
+	const gchar *channel;
+	gsize channel_len;
+	gboolean empty;
+};
+
+static const gchar *prv_skip_space(const gchar *p)
+{
+	while (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r')
+		++p;
+
+	return p;
+}
+
+static const gchar *prv_skip_name(const gchar *p)
+{
+	while (*p && !strchr(" \t\n\r/>=", *p))
+		++p;
+
+	return p;
+}
+
+static gboolean prv_name_is(const gchar *name, gsize name_len,
+			    const gchar *expected)
+{
+	return strlen(expected) == name_len &&
+		!strncmp(name, expected, name_len);
+}
+
+/* Reads the start tag at p, up to its closing '>' or "/>".  Returns the
+ * position after the tag, or NULL if it is not a plain element. */
+
+static const gchar *prv_scan_start_tag(const gchar *p, prv_element_t *element)
+{
+	const gchar *attr;
+	gsize attr_len;
+	const gchar *end;
+	gchar quote;
+
+	memset(element, 0, sizeof(*element));
+
+	if (*p != '<')
+		return NULL;
+
+	element->name = ++p;
+	p = prv_skip_name(p);
+	element->name_len = p - element->name;
+
+	if (!element->name_len || !g_ascii_isalpha(*element->name))
+		return NULL;
+
+	for (;;) {
+		p = prv_skip_space(p);
+
+		if (*p == '>')
+			return p + 1;
+
+		if (p[0] == '/' && p[1] == '>') {
+			element->empty = TRUE;
+			return p + 2;
+		}
+
+		attr = p;
+		p = prv_skip_name(p);
+		attr_len = p - attr;
+		p = prv_skip_space(p);
+
+		if (!attr_len || *p != '=')
+			return NULL;
+
+		p = prv_skip_space(p + 1);
+		quote = *p;
+
+		if (quote != '"' && quote != '\'')
+			return NULL;
+
+		end = strchr(++p, quote);
+		if (!end || memchr(p, '<', end - p))
+			return NULL;
+
+		if (prv_name_is(attr, attr_len, "val")) {
+			element->val = p;
+			element->val_len = end - p;
+		} else if (prv_name_is(attr, attr_len, "channel")) {
+			element->channel = p;
+			element->channel_len = end - p;
+		}
+
+		p = end + 1;
+	}
+}
+
+/* Reads the end tag of the element name at p.  Returns the position after
+ * the tag, or NULL if there is none. */
+
+static const gchar *prv_scan_end_tag(const gchar *p, const gchar *name)
+{
+	const gchar *start;
+
+	if (p[0] != '<' || p[1] != '/')
+		return NULL;
+
+	start = p + 2;
+	p = prv_skip_name(start);
+
+	if (!prv_name_is(start, p - start, name))
+		return NULL;
+
+	p = prv_skip_space(p);
+
+	return *p == '>' ? p + 1 : NULL;
+}
+
+static gboolean prv_decode_entity(const gchar **src, gchar **dest)
+{
+	const gchar *p = *src + 1;
+	const gchar *end = strchr(p, ';');
+	gchar *digits_end;
+	guint64 c;
+
+	if (!end)
+		return FALSE;
+
+	if (*p == '#') {
+		if (p[1] == 'x')
+			c = g_ascii_strtoull(p + 2, &digits_end, 16);
+		else
+			c = g_ascii_strtoull(p + 1, &digits_end, 10);
+
+		if (digits_end != end || !c || c > 0x10FFFF ||
+		    !g_unichar_validate(c))
+			return FALSE;
+
+		*dest += g_unichar_to_utf8(c, *dest);
+	} else if (!strncmp(p, "amp;", 4)) {
+		*(*dest)++ = '&';
+	} else if (!strncmp(p, "lt;", 3)) {
+		*(*dest)++ = '<';
+	} else if (!strncmp(p, "gt;", 3)) {
+		*(*dest)++ = '>';
+	} else if (!strncmp(p, "quot;", 5)) {
+		*(*dest)++ = '"';
+	} else if (!strncmp(p, "apos;", 5)) {
+		*(*dest)++ = '\'';
+	} else {
+		return FALSE;
+	}
+
+	*src = end + 1;
+
+	return TRUE;
+}
+
+/* Copies an attribute value, decoding its entities and normalising its
+ * white space as an XML parser does.  A decoded entity is never longer
+ * than its reference, so the value is decoded within its copy. */
+
+static gchar *prv_decode_value(const gchar *val, gsize val_len)
+{
+	gchar *value = g_strndup(val, val_len);
+	const gchar *src = value;
+	gchar *dest = value;
+
+	if (!memchr(val, '&', val_len) && !strpbrk(value, "\t\n\r"))
+		return value;
+
+	while (*src) {
+		if (*src == '&') {
+			if (!prv_decode_entity(&src, &dest))
+				goto on_error;
+		} else if (*src == '\r' || *src == '\n' || *src == '\t') {
+			if (src[0] == '\r' && src[1] == '\n')
+				++src;
+			*dest++ = ' ';
+			++src;
+		} else {
+			*dest++ = *src++;
+		}
+	}
+
+	*dest = 0;
+
+	return value;
+
+on_error:
+
+	g_free(value);
+
+	return NULL;
+}
+
+static gboolean prv_scan_variable(const prv_element_t *element,
+				  const gchar * const *names, gchar **values,
+				  guint count)
+{
+	guint i;
+
+	if (element->channel &&
+	    !prv_name_is(element->channel, element->channel_len,
+			 RSU_LAST_CHANGE_MASTER))
+		return TRUE;
+
+	for (i = 0; i < count; ++i)
+		if (prv_name_is(element->name, element->name_len, names[i]))
+			break;
+
+	if (i == count || !element->val)
+		return TRUE;
+
+	g_free(values[i]);
+	values[i] = prv_decode_value(element->val, element->val_len);
+
+	return values[i] != NULL;
+}
+
+static gboolean prv_scan_instance(const gchar **p, guint instance_id,
+				  const gchar * const *names, gchar **values,
+				  guint count)
+{
+	prv_element_t element;
+	gboolean wanted;
+	gchar *end;
+
+	*p = prv_scan_start_tag(*p, &element);
+
+	if (!*p || !element.val ||
+	    !prv_name_is(element.name, element.name_len,
+			 RSU_LAST_CHANGE_INSTANCE))
+		return FALSE;
+
+	wanted = g_ascii_strtoull(element.val, &end, 10) == instance_id &&
+		end == element.val + element.val_len && element.val_len;
+
+	if (element.empty)
+		return TRUE;
+
+	for (;;) {
+		*p = prv_skip_space(*p);
+
+		if ((*p)[0] == '<' && (*p)[1] == '/')
+			break;
+
+		*p = prv_scan_start_tag(*p, &element);
+
+		if (!*p || !element.empty)
+			return FALSE;
+
+		if (wanted && !prv_scan_variable(&element, names, values,
+						 count))
+			return FALSE;
+	}
+
+	*p = prv_scan_end_tag(*p, RSU_LAST_CHANGE_INSTANCE);
+
+	return *p != NULL;
+}
+
+static gboolean prv_scan(const gchar *p, guint instance_id,
+			 const gchar * const *names, gchar **values,
+			 guint count)
+{
+	prv_element_t element;
+
+	p = prv_skip_space(p);
+
+	if (!strncmp(p, "<?xml", 5)) {
+		p = strstr(p, "?>");
+		if (!p)
+			return FALSE;
+		p = prv_skip_space(p + 2);
+	}
+
+	p = prv_scan_start_tag(p, &element);
+
+	if (!p || !prv_name_is(element.name, element.name_len,
+			       RSU_LAST_CHANGE_EVENT))
+		return FALSE;
+
+	if (element.empty)
+		return TRUE;
+
+	for (;;) {
+		p = prv_skip_space(p);
+
+		if (p[0] == '<' && p[1] == '/')
+			break;
+
+		if (!prv_scan_instance(&p, instance_id, names, values, count))
+			return FALSE;
+	}
+
+	p = prv_scan_end_tag(p, RSU_LAST_CHANGE_EVENT);
+
+	return p && !*prv_skip_space(p);
+}
+
+static gboolean prv_parse_generic(const gchar *last_change, guint instance_id,
+				  const gchar * const *names, gchar **values,
+				  guint count)
+{
+	GUPnPLastChangeParser *parser;
+	gboolean retval = TRUE;
+	guint i;
+
+	parser = gupnp_last_change_parser_new();
+
+	for (i = 0; i < count && retval; ++i)
+		retval = gupnp_last_change_parser_parse_last_change(
+				parser, instance_id, last_change, NULL,
+				names[i], G_TYPE_STRING, &values[i], NULL);
+
+	g_object_unref(parser);
+
+	return retval;
+}
+
+static void prv_clear_values(gchar **values, guint count)
+{
+	guint i;
+
+	for (i = 0; i < count; ++i) {
+		g_free(values[i]);
+		values[i] = NULL;
+	}
+}
+
+gboolean rsu_last_change_parse(const gchar *last_change, guint instance_id,
+			       const gchar * const *names, gchar **values,
+			       guint count)
+{
+	memset(values, 0, count * sizeof(*values));
+
+	if (!last_change)
+		return FALSE;
+
+	if (prv_scan(last_change, instance_id, names, values, count))
+		return TRUE;
+
+	prv_clear_values(values, count);
+
+	if (prv_parse_generic(last_change, instance_id, names, values, count))
+		return TRUE;
+
+	prv_clear_values(values, count);
+
+	return FALSE;
+}
@@ -0,0 +1,36 @@
+/*
+ * renderer-service-upnp
+ *
+ * Copyright (C) 2013 Intel Corporation. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU Lesser General Public License,
+ * version 2.1, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St - Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ */
+
+
+#ifndef RSU_LAST_CHANGE_H__
+#define RSU_LAST_CHANGE_H__
+
+#include <glib.h>
+
+/* Reads count variables of instance_id from a LastChange event.  values[i]
+ * is set to a newly allocated copy of the value of names[i], or to NULL
+ * if the event does not carry it.  Returns FALSE if the event cannot be
+ * parsed. */
+
+gboolean rsu_last_change_parse(const gchar *last_change, guint instance_id,
+			       const gchar * const *names, gchar **values,
+			       guint count);
+
+#endif /* RSU_LAST_CHANGE_H__ */
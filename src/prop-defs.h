@@ -28,6 +28,7 @@
 #define RSU_INTERFACE_PLAYER "org.mpris.MediaPlayer2.Player"
 
 #define RSU_INTERFACE_PROPERTIES_CHANGED "PropertiesChanged"
+#define RSU_INTERFACE_SEEKED "Seeked"
 
 #define RSU_INTERFACE_PROP_CAN_QUIT "CanQuit"
 #define RSU_INTERFACE_PROP_CAN_RAISE "CanRaise"
@@ -0,0 +1,133 @@
+/*
+ * renderer-service-upnp
+ *
+ * Copyright (C) 2013 Intel Corporation. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU Lesser General Public License,
+ * version 2.1, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St - Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ */
+
+
+#include <string.h>
+
+#include "prop-defs.h"
+#include "props.h"
+
+/* Property names are looked up in an open table without collisions.  The
+ * multiplier of the string hash is chosen, the first time a name is
+ * looked up, so that no two names share a slot.  The names being fixed,
+ * the search always ends on the same multiplier, 77 for the current set.
+ * A lookup then costs a hash and a single string comparison. */
+
+#define RSU_PROP_HASH_SIZE 128
+
+static const gchar *g_prop_names[RSU_PROP_MAX] = {
+	RSU_INTERFACE_PROP_CAN_QUIT,
+	RSU_INTERFACE_PROP_CAN_RAISE,
+	RSU_INTERFACE_PROP_CAN_SET_FULLSCREEN,
+	RSU_INTERFACE_PROP_HAS_TRACK_LIST,
+	RSU_INTERFACE_PROP_IDENTITY,
+	RSU_INTERFACE_PROP_SUPPORTED_URIS,
+	RSU_INTERFACE_PROP_SUPPORTED_MIME,
+
+	RSU_INTERFACE_PROP_PLAYBACK_STATUS,
+	RSU_INTERFACE_PROP_RATE,
+	RSU_INTERFACE_PROP_CAN_PLAY,
+	RSU_INTERFACE_PROP_CAN_SEEK,
+	RSU_INTERFACE_PROP_CAN_CONTROL,
+	RSU_INTERFACE_PROP_CAN_PAUSE,
+	RSU_INTERFACE_PROP_CAN_NEXT,
+	RSU_INTERFACE_PROP_CAN_PREVIOUS,
+	RSU_INTERFACE_PROP_POSITION,
+	RSU_INTERFACE_PROP_METADATA,
+	RSU_INTERFACE_PROP_TRANSPORT_PLAY_SPEEDS,
+	RSU_INTERFACE_PROP_MINIMUM_RATE,
+	RSU_INTERFACE_PROP_MAXIMUM_RATE,
+	RSU_INTERFACE_PROP_VOLUME,
+	RSU_INTERFACE_PROP_CURRENT_TRACK,
+	RSU_INTERFACE_PROP_NUMBER_OF_TRACKS,
+
+	RSU_INTERFACE_PROP_DEVICE_TYPE,
+	RSU_INTERFACE_PROP_UDN,
+	RSU_INTERFACE_PROP_FRIENDLY_NAME,
+	RSU_INTERFACE_PROP_ICON_URL,
+	RSU_INTERFACE_PROP_MANUFACTURER,
+	RSU_INTERFACE_PROP_MANUFACTURER_URL,
+	RSU_INTERFACE_PROP_MODEL_DESCRIPTION,
+	RSU_INTERFACE_PROP_MODEL_NAME,
+	RSU_INTERFACE_PROP_MODEL_NUMBER,
+	RSU_INTERFACE_PROP_SERIAL_NUMBER,
+	RSU_INTERFACE_PROP_PRESENTATION_URL,
+	RSU_INTERFACE_PROP_PROTOCOL_INFO
+};
+
+static guint8 g_prop_slots[RSU_PROP_HASH_SIZE];
+static guint g_prop_multiplier;
+
+static guint prv_prop_hash(const gchar *name, guint multiplier)
+{
+	guint hash = 0;
+
+	while (*name)
+		hash = hash * multiplier + (guchar)*name++;
+
+	return hash % RSU_PROP_HASH_SIZE;
+}
+
+static gboolean prv_prop_fill_slots(guint multiplier)
+{
+	guint i;
+	guint slot;
+
+	memset(g_prop_slots, RSU_PROP_MAX, sizeof(g_prop_slots));
+
+	for (i = 0; i < RSU_PROP_MAX; ++i) {
+		slot = prv_prop_hash(g_prop_names[i], multiplier);
+		if (g_prop_slots[slot] != RSU_PROP_MAX)
+			return FALSE;
+		g_prop_slots[slot] = i;
+	}
+
+	return TRUE;
+}
+
+static void prv_prop_init(void)
+{
+	guint multiplier = 31;
+
+	while (!prv_prop_fill_slots(multiplier))
+		multiplier += 2;
+
+	g_prop_multiplier = multiplier;
+}
+
+rsu_prop_t rsu_prop_from_name(const gchar *name)
+{
+	rsu_prop_t prop;
+
+	if (!g_prop_multiplier)
+		prv_prop_init();
+
+	prop = g_prop_slots[prv_prop_hash(name, g_prop_multiplier)];
+
+	if (prop == RSU_PROP_MAX || strcmp(g_prop_names[prop], name))
+		return RSU_PROP_MAX;
+
+	return prop;
+}
+
+const gchar *rsu_prop_get_name(rsu_prop_t prop)
+{
+	return g_prop_names[prop];
+}
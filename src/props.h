@@ -0,0 +1,80 @@
+/*
+ * renderer-service-upnp
+ *
+ * Copyright (C) 2013 Intel Corporation. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU Lesser General Public License,
+ * version 2.1, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St - Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ */
+
+
+#ifndef RSU_PROPS_H__
+#define RSU_PROPS_H__
+
+#include <glib.h>
+
+/* Properties of the renderer objects, grouped by interface.  Each group
+ * starts with the first property of its interface. */
+
+enum rsu_prop_t_ {
+	RSU_PROP_CAN_QUIT,
+	RSU_PROP_CAN_RAISE,
+	RSU_PROP_CAN_SET_FULLSCREEN,
+	RSU_PROP_HAS_TRACK_LIST,
+	RSU_PROP_IDENTITY,
+	RSU_PROP_SUPPORTED_URIS,
+	RSU_PROP_SUPPORTED_MIME,
+
+	RSU_PROP_PLAYBACK_STATUS,
+	RSU_PROP_RATE,
+	RSU_PROP_CAN_PLAY,
+	RSU_PROP_CAN_SEEK,
+	RSU_PROP_CAN_CONTROL,
+	RSU_PROP_CAN_PAUSE,
+	RSU_PROP_CAN_NEXT,
+	RSU_PROP_CAN_PREVIOUS,
+	RSU_PROP_POSITION,
+	RSU_PROP_METADATA,
+	RSU_PROP_TRANSPORT_PLAY_SPEEDS,
+	RSU_PROP_MINIMUM_RATE,
+	RSU_PROP_MAXIMUM_RATE,
+	RSU_PROP_VOLUME,
+	RSU_PROP_CURRENT_TRACK,
+	RSU_PROP_NUMBER_OF_TRACKS,
+
+	RSU_PROP_DEVICE_TYPE,
+	RSU_PROP_UDN,
+	RSU_PROP_FRIENDLY_NAME,
+	RSU_PROP_ICON_URL,
+	RSU_PROP_MANUFACTURER,
+	RSU_PROP_MANUFACTURER_URL,
+	RSU_PROP_MODEL_DESCRIPTION,
+	RSU_PROP_MODEL_NAME,
+	RSU_PROP_MODEL_NUMBER,
+	RSU_PROP_SERIAL_NUMBER,
+	RSU_PROP_PRESENTATION_URL,
+	RSU_PROP_PROTOCOL_INFO,
+
+	RSU_PROP_MAX
+};
+typedef enum rsu_prop_t_ rsu_prop_t;
+
+#define RSU_PROP_ROOT_FIRST RSU_PROP_CAN_QUIT
+#define RSU_PROP_PLAYER_FIRST RSU_PROP_PLAYBACK_STATUS
+#define RSU_PROP_DEVICE_FIRST RSU_PROP_DEVICE_TYPE
+
+rsu_prop_t rsu_prop_from_name(const gchar *name);
+const gchar *rsu_prop_get_name(rsu_prop_t prop);
+
+#endif /* RSU_PROPS_H__ */
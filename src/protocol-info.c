@@ -0,0 +1,324 @@
+/*
+ * renderer-service-upnp
+ *
+ * Copyright (C) 2013 Intel Corporation. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU Lesser General Public License,
+ * version 2.1, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St - Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ */
+
+
+#include <string.h>
+
+#include "protocol-info.h"
+
+/* A ProtocolInfo is a comma separated list of entries, each made of four
+ * colon separated fields, e.g.
+ *
+ * http-get:*:audio/mpeg:DLNA.ORG_PN=MP3;DLNA.ORG_OP=01;DLNA.ORG_FLAGS=...
+ *
+ * The string is parsed once into a copy split in place, the entries
+ * pointing to their fields within it. */
+
+typedef struct prv_entry_t_ prv_entry_t;
+struct prv_entry_t_ {
+	const gchar *protocol;
+	const gchar *network;
+	const gchar *mime_type;
+	const gchar *profile;
+	guint operations;
+	guint32 flags;
+};
+
+struct rsu_protocol_info_t_ {
+	gchar *string;
+	gchar *fields;
+	GArray *entries;
+};
+
+#define RSU_PROTOCOL_INFO_PN "DLNA.ORG_PN="
+#define RSU_PROTOCOL_INFO_OP "DLNA.ORG_OP="
+#define RSU_PROTOCOL_INFO_FLAGS "DLNA.ORG_FLAGS="
+
+/* Cuts str at the first sep and returns what follows, or NULL */
+
+static gchar *prv_cut(gchar *str, gchar sep)
+{
+	gchar *end = strchr(str, sep);
+
+	if (!end)
+		return NULL;
+
+	*end = 0;
+
+	return end + 1;
+}
+
+static void prv_parse_additional_info(gchar *info, prv_entry_t *entry)
+{
+	gchar *next;
+	gchar flags[9];
+
+	for (; info; info = next) {
+		next = prv_cut(info, ';');
+
+		if (g_str_has_prefix(info, RSU_PROTOCOL_INFO_PN)) {
+			entry->profile = info + strlen(RSU_PROTOCOL_INFO_PN);
+		} else if (g_str_has_prefix(info, RSU_PROTOCOL_INFO_OP)) {
+			info += strlen(RSU_PROTOCOL_INFO_OP);
+			entry->operations = g_ascii_strtoull(info, NULL, 16);
+		} else if (g_str_has_prefix(info, RSU_PROTOCOL_INFO_FLAGS)) {
+			/* Only the 8 first digits of the 32 are defined */
+			g_strlcpy(flags, info + strlen(RSU_PROTOCOL_INFO_FLAGS),
+				  sizeof(flags));
+			entry->flags = g_ascii_strtoull(flags, NULL, 16);
+		}
+	}
+}
+
+static gboolean prv_parse_entry(gchar *str, prv_entry_t *entry)
+{
+	gchar *info;
+
+	memset(entry, 0, sizeof(*entry));
+
+	entry->protocol = g_strstrip(str);
+	entry->network = prv_cut(str, ':');
+	if (!entry->network)
+		return FALSE;
+
+	entry->mime_type = prv_cut((gchar *)entry->network, ':');
+	if (!entry->mime_type)
+		return FALSE;
+
+	info = prv_cut((gchar *)entry->mime_type, ':');
+	if (info && strcmp(info, "*"))
+		prv_parse_additional_info(info, entry);
+
+	return TRUE;
+}
+
+rsu_protocol_info_t *rsu_protocol_info_new(const gchar *protocol_info)
+{
+	rsu_protocol_info_t *info;
+	prv_entry_t entry;
+	gchar *str;
+	gchar *next;
+
+	info = g_new0(rsu_protocol_info_t, 1);
+	info->string = g_strdup(protocol_info);
+	info->fields = g_strdup(protocol_info);
+	info->entries = g_array_new(FALSE, FALSE, sizeof(prv_entry_t));
+
+	for (str = info->fields; str; str = next) {
+		next = prv_cut(str, ',');
+
+		if (prv_parse_entry(str, &entry))
+			g_array_append_val(info->entries, entry);
+	}
+
+	return info;
+}
+
+void rsu_protocol_info_free(rsu_protocol_info_t *info)
+{
+	if (info) {
+		g_array_unref(info->entries);
+		g_free(info->fields);
+		g_free(info->string);
+		g_free(info);
+	}
+}
+
+const gchar *rsu_protocol_info_get_string(const rsu_protocol_info_t *info)
+{
+	return info->string;
+}
+
+static GVariant *prv_as_from_hash_table(GHashTable *values)
+{
+	GVariantBuilder vb;
+	GHashTableIter iter;
+	gpointer key;
+
+	g_variant_builder_init(&vb, G_VARIANT_TYPE("as"));
+	g_hash_table_iter_init(&iter, values);
+
+	while (g_hash_table_iter_next(&iter, &key, NULL))
+		g_variant_builder_add(&vb, "s", key);
+
+	return g_variant_builder_end(&vb);
+}
+
+GVariant *rsu_protocol_info_get_schemes(const rsu_protocol_info_t *info)
+{
+	const char http_prefix[] = "http-";
+	GHashTable *schemes;
+	GVariant *retval;
+	prv_entry_t *entry;
+	gchar *scheme;
+	guint i;
+
+	schemes = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, NULL);
+
+	for (i = 0; i < info->entries->len; ++i) {
+		entry = &g_array_index(info->entries, prv_entry_t, i);
+		scheme = g_ascii_strdown(entry->protocol, -1);
+
+		if (g_str_has_prefix(scheme, http_prefix))
+			scheme[sizeof(http_prefix) - 2] = 0;
+
+		g_hash_table_insert(schemes, scheme, NULL);
+	}
+
+	retval = prv_as_from_hash_table(schemes);
+	g_hash_table_unref(schemes);
+
+	return retval;
+}
+
+GVariant *rsu_protocol_info_get_mime_types(const rsu_protocol_info_t *info)
+{
+	GHashTable *types;
+	GVariant *retval;
+	prv_entry_t *entry;
+	guint i;
+
+	types = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, NULL);
+
+	for (i = 0; i < info->entries->len; ++i) {
+		entry = &g_array_index(info->entries, prv_entry_t, i);
+		g_hash_table_insert(types,
+				    g_ascii_strdown(entry->mime_type, -1),
+				    NULL);
+	}
+
+	retval = prv_as_from_hash_table(types);
+	g_hash_table_unref(types);
+
+	return retval;
+}
+
+/* Compares the first len characters of str, ignoring case, with the whole
+ * of expected */
+
+static gboolean prv_prefix_is(const gchar *str, gsize len,
+			      const gchar *expected)
+{
+	return strlen(expected) == len &&
+		!g_ascii_strncasecmp(str, expected, len);
+}
+
+gboolean rsu_protocol_info_accepts_uri(const rsu_protocol_info_t *info,
+				       const gchar *uri)
+{
+	const prv_entry_t *entry;
+	const gchar *end;
+	gsize len;
+	guint i;
+
+	end = strchr(uri, ':');
+	if (!end || end == uri || !info->entries->len)
+		return TRUE;
+
+	len = end - uri;
+
+	/* https is served by renderers able to get http */
+
+	if (prv_prefix_is(uri, len, "https"))
+		len = strlen("http");
+
+	for (i = 0; i < info->entries->len; ++i) {
+		entry = &g_array_index(info->entries, prv_entry_t, i);
+
+		if (!strcmp(entry->protocol, "*"))
+			return TRUE;
+
+		/* Protocols are named after the scheme, e.g. http-get or
+		   rtsp-rtp-udp */
+
+		end = strchr(entry->protocol, '-');
+		if (!end)
+			end = entry->protocol + strlen(entry->protocol);
+
+		if (end - entry->protocol == len &&
+		    !g_ascii_strncasecmp(entry->protocol, uri, len))
+			return TRUE;
+	}
+
+	return FALSE;
+}
+
+/* Length of a MIME type without its parameters, as in
+ * audio/L16;rate=44100 */
+
+static gsize prv_mime_type_len(const gchar *mime_type)
+{
+	const gchar *end = strchr(mime_type, ';');
+
+	return end ? end - mime_type : strlen(mime_type);
+}
+
+static gboolean prv_mime_type_matches(const gchar *pattern,
+				      const gchar *mime_type)
+{
+	gsize pattern_len;
+	gsize len;
+
+	if (!strcmp(pattern, "*"))
+		return TRUE;
+
+	pattern_len = prv_mime_type_len(pattern);
+	len = prv_mime_type_len(mime_type);
+
+	if (pattern_len >= 2 && !strncmp(pattern + pattern_len - 2, "/*", 2))
+		return len >= pattern_len &&
+			!g_ascii_strncasecmp(pattern, mime_type,
+					     pattern_len - 1);
+
+	return len == pattern_len &&
+		!g_ascii_strncasecmp(pattern, mime_type, len);
+}
+
+gboolean rsu_protocol_info_accepts_type(const rsu_protocol_info_t *info,
+					const gchar *protocol,
+					const gchar *mime_type,
+					const gchar *profile)
+{
+	const prv_entry_t *entry;
+	guint i;
+
+	if (!info->entries->len)
+		return TRUE;
+
+	for (i = 0; i < info->entries->len; ++i) {
+		entry = &g_array_index(info->entries, prv_entry_t, i);
+
+		if (protocol && strcmp(entry->protocol, "*") &&
+		    g_ascii_strcasecmp(entry->protocol, protocol))
+			continue;
+
+		if (mime_type &&
+		    !prv_mime_type_matches(entry->mime_type, mime_type))
+			continue;
+
+		if (profile && entry->profile &&
+		    g_ascii_strcasecmp(entry->profile, profile))
+			continue;
+
+		return TRUE;
+	}
+
+	return FALSE;
+}
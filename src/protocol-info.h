@@ -0,0 +1,51 @@
+/*
+ * renderer-service-upnp
+ *
+ * Copyright (C) 2013 Intel Corporation. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU Lesser General Public License,
+ * version 2.1, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St - Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ */
+
+
+#ifndef RSU_PROTOCOL_INFO_H__
+#define RSU_PROTOCOL_INFO_H__
+
+#include <glib.h>
+
+typedef struct rsu_protocol_info_t_ rsu_protocol_info_t;
+
+rsu_protocol_info_t *rsu_protocol_info_new(const gchar *protocol_info);
+void rsu_protocol_info_free(rsu_protocol_info_t *info);
+const gchar *rsu_protocol_info_get_string(const rsu_protocol_info_t *info);
+
+/* Values of the SupportedUriSchemes and SupportedMimeTypes properties, as
+ * floating "as" variants. */
+
+GVariant *rsu_protocol_info_get_schemes(const rsu_protocol_info_t *info);
+GVariant *rsu_protocol_info_get_mime_types(const rsu_protocol_info_t *info);
+
+/* Both return TRUE if the ProtocolInfo lists at least one format matching
+ * their parameters, or if it lists none, in which case the renderer is
+ * left to decide.  Only the scheme of uri is considered.  mime_type and
+ * profile, a DLNA profile name, may be NULL to match any. */
+
+gboolean rsu_protocol_info_accepts_uri(const rsu_protocol_info_t *info,
+				       const gchar *uri);
+gboolean rsu_protocol_info_accepts_type(const rsu_protocol_info_t *info,
+					const gchar *protocol,
+					const gchar *mime_type,
+					const gchar *profile);
+
+#endif /* RSU_PROTOCOL_INFO_H__ */
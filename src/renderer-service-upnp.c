@@ -91,11 +91,18 @@
 #define RSU_INTERFACE_GOTO_TRACK "GotoTrack"
 
 #define RSU_INTERFACE_CANCEL "Cancel"
+#define RSU_INTERFACE_SUBSCRIBE_POSITION "SubscribePosition"
+#define RSU_INTERFACE_UNSUBSCRIBE_POSITION "UnsubscribePosition"
+#define RSU_INTERFACE_INTERVAL "Interval"
+
+#define RSU_INTERFACE_GET_STATISTICS "GetStatistics"
+#define RSU_INTERFACE_STATISTICS_VALUE "statistics"
 
 typedef struct rsu_context_t_ rsu_context_t;
 struct rsu_context_t_ {
 	bool error;
 	guint rsu_id;
+	guint stats_id;
 	guint sig_id;
 	guint owner_id;
 	GDBusNodeInfo *root_node_info;
@@ -130,6 +137,12 @@ static const gchar g_rsu_root_introspection[] =
 	"      <arg type='s' name='"RSU_INTERFACE_PATH"'/>"
 	"    </signal>"
 	"  </interface>"
+	"  <interface name='"RSU_INTERFACE_STATISTICS"'>"
+	"    <method name='"RSU_INTERFACE_GET_STATISTICS"'>"
+	"      <arg type='a{sv}' name='"RSU_INTERFACE_STATISTICS_VALUE"'"
+	"           direction='out'/>"
+	"    </method>"
+	"  </interface>"
 	"</node>";
 
 static const gchar g_rsu_server_introspection[] =
@@ -214,6 +227,9 @@ static const gchar g_rsu_server_introspection[] =
 	"      <arg type='u' name='"RSU_INTERFACE_TRACK_NUMBER"'"
 	"           direction='in'/>"
 	"    </method>"
+	"    <signal name='"RSU_INTERFACE_SEEKED"'>"
+	"      <arg type='x' name='"RSU_INTERFACE_POSITION"'/>"
+	"    </signal>"
 	"    <property type='s' name='"RSU_INTERFACE_PROP_PLAYBACK_STATUS"'"
 	"       access='read'/>"
 	"    <property type='d' name='"RSU_INTERFACE_PROP_RATE"'"
@@ -263,6 +279,12 @@ static const gchar g_rsu_server_introspection[] =
 	"  <interface name='"RSU_INTERFACE_RENDERER_DEVICE"'>"
 	"    <method name='"RSU_INTERFACE_CANCEL"'>"
 	"    </method>"
+	"    <method name='"RSU_INTERFACE_SUBSCRIBE_POSITION"'>"
+	"      <arg type='u' name='"RSU_INTERFACE_INTERVAL"'"
+	"           direction='in'/>"
+	"    </method>"
+	"    <method name='"RSU_INTERFACE_UNSUBSCRIBE_POSITION"'>"
+	"    </method>"
 	"    <property type='s' name='"RSU_INTERFACE_PROP_DEVICE_TYPE"'"
 	"       access='read'/>"
 	"    <property type='s' name='"RSU_INTERFACE_PROP_UDN"'"
@@ -346,12 +368,27 @@ static void prv_renderer_device_method_call(GDBusConnection *conn,
 					    GDBusMethodInvocation *invocation,
 					    gpointer user_data);
 
+static void prv_rsu_stats_method_call(GDBusConnection *conn,
+				      const gchar *sender,
+				      const gchar *object,
+				      const gchar *interface,
+				      const gchar *method,
+				      GVariant *parameters,
+				      GDBusMethodInvocation *invocation,
+				      gpointer user_data);
+
 static const GDBusInterfaceVTable g_rsu_vtable = {
 	prv_rsu_method_call,
 	NULL,
 	NULL
 };
 
+static const GDBusInterfaceVTable g_rsu_stats_vtable = {
+	prv_rsu_stats_method_call,
+	NULL,
+	NULL
+};
+
 static const GDBusInterfaceVTable g_props_vtable = {
 	prv_props_method_call,
 	NULL,
@@ -418,26 +455,23 @@ static gboolean prv_context_quit_cb(gpointer user_data)
 	return FALSE;
 }
 
-static void prv_process_sync_task(rsu_task_t *task)
+static void prv_run_sync_task(rsu_task_t *task)
 {
 	GError *error;
 
 	switch (task->type) {
 	case RSU_TASK_GET_VERSION:
 		rsu_task_complete(task);
-		rsu_task_queue_task_completed(task->atom.queue_id);
 		break;
 	case RSU_TASK_GET_SERVERS:
 		task->result = rsu_upnp_get_server_ids(g_context.upnp);
 		rsu_task_complete(task);
-		rsu_task_queue_task_completed(task->atom.queue_id);
 		break;
 	case RSU_TASK_RAISE:
 	case RSU_TASK_QUIT:
 		error = g_error_new(RSU_ERROR, RSU_ERROR_NOT_SUPPORTED,
 				    "Command not supported.");
 		rsu_task_fail(task, error);
-		rsu_task_queue_task_completed(task->atom.queue_id);
 		g_error_free(error);
 		break;
 	default:
@@ -445,6 +479,46 @@ static void prv_process_sync_task(rsu_task_t *task)
 	}
 }
 
+static void prv_process_sync_task(rsu_task_t *task)
+{
+	prv_run_sync_task(task);
+	rsu_task_queue_task_completed(&task->atom);
+}
+
+/* Reads that need no network round trip are answered without going
+ * through the task queue.  The caller makes sure they cannot overtake a
+ * request sent earlier by the same client. */
+
+static gboolean prv_run_fast_read(rsu_task_t *task)
+{
+	GError *error = NULL;
+
+	switch (task->type) {
+	case RSU_TASK_GET_VERSION:
+	case RSU_TASK_GET_SERVERS:
+		prv_run_sync_task(task);
+		break;
+	case RSU_TASK_GET_PROP:
+	case RSU_TASK_GET_ALL_PROPS:
+		if (!rsu_device_is_cached_read(task))
+			return FALSE;
+
+		if (rsu_upnp_get_cached_props(g_context.upnp, task, &error)) {
+			rsu_task_complete(task);
+		} else {
+			rsu_task_fail(task, error);
+			g_error_free(error);
+		}
+		break;
+	default:
+		return FALSE;
+	}
+
+	rsu_task_delete(task);
+
+	return TRUE;
+}
+
 static void prv_async_task_complete(rsu_task_t *task, GError *error)
 {
 	RSU_LOG_DEBUG("Enter");
@@ -456,7 +530,7 @@ static void prv_async_task_complete(rsu_task_t *task, GError *error)
 		rsu_task_complete(task);
 	}
 
-	rsu_task_queue_task_completed(task->atom.queue_id);
+	rsu_task_queue_task_completed(&task->atom);
 
 	RSU_LOG_DEBUG("Exit");
 }
@@ -467,7 +541,7 @@ static void prv_process_async_task(rsu_task_t *task)
 
 	RSU_LOG_DEBUG("Enter");
 
-	async_task->cancellable = g_cancellable_new();
+	async_task->cancellable = rsu_async_cancellable_new();
 
 	switch (task->type) {
 	case RSU_TASK_GET_PROP:
@@ -557,6 +631,14 @@ static void prv_delete_task(rsu_task_atom_t *task, gpointer user_data)
 	rsu_task_delete((rsu_task_t *)task);
 }
 
+static gboolean prv_coalesce_task(rsu_task_atom_t *old_task,
+				  rsu_task_atom_t *new_task,
+				  gpointer user_data)
+{
+	return rsu_task_coalesce((rsu_task_t *)old_task,
+				 (rsu_task_t *)new_task);
+}
+
 static void prv_rsu_context_init(void)
 {
 	memset(&g_context, 0, sizeof(g_context));
@@ -581,6 +663,11 @@ static void prv_rsu_context_free(void)
 			g_dbus_connection_unregister_object(
 							g_context.connection,
 							g_context.rsu_id);
+
+		if (g_context.stats_id)
+			g_dbus_connection_unregister_object(
+							g_context.connection,
+							g_context.stats_id);
 	}
 
 	if (g_context.main_loop)
@@ -621,13 +708,120 @@ static void prv_lost_client(GDBusConnection *connection, const gchar *name,
 	prv_remove_client(name);
 }
 
-static void prv_add_task(rsu_task_t *task, const gchar *sink)
+static void prv_client_pid_cb(GObject *source_object, GAsyncResult *res,
+			      gpointer user_data)
 {
-	const gchar *client_name;
-	guint watcher_id;
-	const rsu_task_queue_key_t *queue_id;
+	gchar *client_name = user_data;
+	GVariant *result;
+	guint32 pid;
+	gchar *path;
+	gchar *program = NULL;
+	guint weight;
+
+	result = g_dbus_connection_call_finish(G_DBUS_CONNECTION(source_object),
+					       res, NULL);
+	if (!result)
+		goto on_error;
 
-	client_name = g_dbus_method_invocation_get_sender(task->invocation);
+	g_variant_get(result, "(u)", &pid);
+	g_variant_unref(result);
+
+	/* The client may have gone while its program was looked up */
+
+	if (!g_hash_table_lookup(g_context.watchers, client_name))
+		goto on_error;
+
+	path = g_strdup_printf("/proc/%u/comm", pid);
+	(void) g_file_get_contents(path, &program, NULL, NULL);
+	g_free(path);
+
+	if (!program)
+		goto on_error;
+
+	g_strstrip(program);
+	weight = rsu_settings_get_client_weight(g_context.settings, program);
+
+	RSU_LOG_INFO("Client %s is %s, weight %u", client_name, program,
+		     weight);
+
+	rsu_task_processor_set_source_weight(g_context.processor, client_name,
+					     weight);
+
+on_error:
+
+	g_free(program);
+	g_free(client_name);
+}
+
+static void prv_lookup_client_weight(const gchar *client_name)
+{
+	if (!rsu_settings_has_client_weights(g_context.settings))
+		return;
+
+	g_dbus_connection_call(g_context.connection,
+			       "org.freedesktop.DBus",
+			       "/org/freedesktop/DBus",
+			       "org.freedesktop.DBus",
+			       "GetConnectionUnixProcessID",
+			       g_variant_new("(s)", client_name),
+			       G_VARIANT_TYPE("(u)"),
+			       G_DBUS_CALL_FLAGS_NONE, -1, NULL,
+			       prv_client_pid_cb, g_strdup(client_name));
+}
+
+/* Options of the [general] section not read where they are used */
+
+static void prv_apply_settings(rsu_settings_context_t *settings)
+{
+	rsu_task_processor_set_max_tasks_per_sink(
+		g_context.processor,
+		rsu_settings_get_max_tasks_per_renderer(settings));
+	rsu_task_processor_set_pipeline_depth(
+		g_context.processor,
+		rsu_settings_get_pipeline_depth(settings));
+	rsu_task_processor_set_dispatch_budget(
+		g_context.processor,
+		rsu_settings_get_dispatch_budget(settings));
+	rsu_task_processor_set_task_timeout(
+		g_context.processor,
+		rsu_settings_get_task_timeout(settings));
+	rsu_task_processor_set_max_queued(
+		g_context.processor,
+		rsu_settings_get_max_queued_tasks(settings),
+		rsu_settings_get_max_queued_tasks_per_client(settings));
+	rsu_device_set_position_resync_interval(
+		rsu_settings_get_position_resync_interval(settings));
+	rsu_device_set_position_read_timeout(
+		rsu_settings_get_task_timeout(settings));
+	rsu_device_set_properties_changed_window(
+		rsu_settings_get_properties_changed_window(settings));
+}
+
+/* Options changed while the service runs apply to the tasks queued from
+ * then on, and client weights to the clients already known as well */
+
+static void prv_settings_changed_cb(rsu_settings_context_t *settings,
+				    gpointer user_data)
+{
+	GHashTableIter iter;
+	gpointer key;
+
+	prv_apply_settings(settings);
+
+	g_hash_table_iter_init(&iter, g_context.watchers);
+
+	while (g_hash_table_iter_next(&iter, &key, NULL)) {
+		if (rsu_settings_has_client_weights(settings))
+			prv_lookup_client_weight(key);
+		else
+			rsu_task_processor_set_source_weight(
+				g_context.processor, key, 1);
+	}
+}
+
+static void prv_watch_client(const gchar *client_name)
+{
+	guint watcher_id;
 
 	if (!g_hash_table_lookup(g_context.watchers, client_name)) {
 		watcher_id = g_bus_watch_name(G_BUS_TYPE_SESSION, client_name,
@@ -637,21 +831,64 @@ static void prv_add_task(rsu_task_t *task, const gchar *sink)
 
 		g_hash_table_insert(g_context.watchers, g_strdup(client_name),
 				    GUINT_TO_POINTER(watcher_id));
+
+		prv_lookup_client_weight(client_name);
 	}
+}
+
+static void prv_add_task(rsu_task_t *task, const gchar *sink)
+{
+	const gchar *client_name;
+	const rsu_task_queue_key_t *queue_id;
+	guint32 flags;
+	GError *error;
+
+	client_name = g_dbus_method_invocation_get_sender(task->invocation);
+
+	prv_watch_client(client_name);
 
 	queue_id = rsu_task_processor_lookup_queue(g_context.processor,
 						   client_name, sink);
-	if (!queue_id)
+
+	if ((!queue_id || rsu_task_queue_is_idle(queue_id)) &&
+	    prv_run_fast_read(task))
+		return;
+
+	if (!queue_id) {
+		/* Tasks sent to renderers by all clients share the in-flight
+		   limit of their renderer.  Transport commands are dispatched
+		   before the property reads queued by the same client. */
+
+		flags = RSU_TASK_QUEUE_FLAG_AUTO_START |
+			RSU_TASK_QUEUE_FLAG_BOUNDED;
+		if (strcmp(sink, RSU_SINK))
+			flags |= RSU_TASK_QUEUE_FLAG_LIMIT_SINK |
+				RSU_TASK_QUEUE_FLAG_PRIORITY;
+
 		queue_id = rsu_task_processor_add_queue(
 						g_context.processor,
 						client_name,
 						sink,
-						RSU_TASK_QUEUE_FLAG_AUTO_START,
+						flags,
 						prv_process_task,
 						prv_cancel_task,
 						prv_delete_task);
 
-	rsu_task_queue_add_task(queue_id, &task->atom);
+		if ((flags & RSU_TASK_QUEUE_FLAG_PRIORITY) &&
+		    rsu_settings_is_coalesce_tasks(g_context.settings))
+			rsu_task_queue_set_coalesce(queue_id,
+						    prv_coalesce_task);
+	}
+
+	if (!rsu_task_queue_add_task(queue_id, &task->atom)) {
+		error = g_error_new(RSU_ERROR, RSU_ERROR_BUSY,
+				    "Too many requests queued.");
+		g_dbus_method_invocation_return_gerror(task->invocation, error);
+		g_error_free(error);
+
+		task->invocation = NULL;
+		rsu_task_delete(task);
+	}
 }
 
 static void prv_rsu_method_call(GDBusConnection *conn,
@@ -686,6 +923,32 @@ finished:
 	return;
 }
 
+static void prv_rsu_stats_method_call(GDBusConnection *conn,
+				      const gchar *sender,
+				      const gchar *object,
+				      const gchar *interface,
+				      const gchar *method,
+				      GVariant *parameters,
+				      GDBusMethodInvocation *invocation,
+				      gpointer user_data)
+{
+	GVariantBuilder vb;
+
+	RSU_LOG_INFO("Calling %s method", method);
+
+	/* Statistics are read directly, so that they remain available
+	   when the task queues are saturated. */
+
+	if (!strcmp(method, RSU_INTERFACE_GET_STATISTICS)) {
+		g_variant_builder_init(&vb, G_VARIANT_TYPE("a{sv}"));
+		rsu_task_processor_add_statistics(g_context.processor, &vb);
+		rsu_task_add_statistics(&vb);
+		rsu_async_add_statistics(&vb);
+		g_dbus_method_invocation_return_value(
+			invocation, g_variant_new("(a{sv})", &vb));
+	}
+}
+
 static const gchar *prv_get_device_id(const gchar *object, GError **error)
 {
 	rsu_device_t *device;
@@ -884,6 +1147,7 @@ static void prv_renderer_device_method_call(GDBusConnection *conn,
 	GError *error = NULL;
 	const gchar *client_name;
 	const rsu_task_queue_key_t *queue_id;
+	guint interval;
 
 	device_id = prv_get_device_id(object, &error);
 	if (!device_id) {
@@ -893,14 +1157,37 @@ static void prv_renderer_device_method_call(GDBusConnection *conn,
 		goto finished;
 	}
 
-	if (!strcmp(method, RSU_INTERFACE_CANCEL)) {
-		client_name = g_dbus_method_invocation_get_sender(invocation);
+	client_name = g_dbus_method_invocation_get_sender(invocation);
 
+	if (!strcmp(method, RSU_INTERFACE_CANCEL)) {
 		queue_id = rsu_task_processor_lookup_queue(g_context.processor,
 							client_name, device_id);
 		if (queue_id)
 			rsu_task_processor_cancel_queue(queue_id);
 
+		g_dbus_method_invocation_return_value(invocation, NULL);
+	} else if (!strcmp(method, RSU_INTERFACE_SUBSCRIBE_POSITION)) {
+		g_variant_get(parameters, "(u)", &interval);
+
+		if (!interval) {
+			g_dbus_method_invocation_return_error(
+						invocation, RSU_ERROR,
+						RSU_ERROR_BAD_QUERY,
+						"Interval must not be 0");
+			goto finished;
+		}
+
+		/* The subscription ends with the client */
+
+		prv_watch_client(client_name);
+		rsu_upnp_subscribe_position(g_context.upnp, device_id,
+					    client_name, interval);
+
+		g_dbus_method_invocation_return_value(invocation, NULL);
+	} else if (!strcmp(method, RSU_INTERFACE_UNSUBSCRIBE_POSITION)) {
+		rsu_upnp_unsubscribe_position(g_context.upnp, device_id,
+					      client_name);
+
 		g_dbus_method_invocation_return_value(invocation, NULL);
 	}
 
@@ -952,7 +1239,15 @@ static void prv_bus_acquired(GDBusConnection *connection, const gchar *name,
 						  &g_rsu_vtable,
 						  NULL, NULL, NULL);
 
-	if (!g_context.rsu_id) {
+	if (g_context.rsu_id)
+		g_context.stats_id =
+			g_dbus_connection_register_object(
+					connection, RSU_OBJECT,
+					g_context.root_node_info->interfaces[1],
+					&g_rsu_stats_vtable,
+					NULL, NULL, NULL);
+
+	if (!g_context.rsu_id || !g_context.stats_id) {
 		RSU_LOG_DEBUG("Failed to acquire Bus %s", name);
 		g_context.error = true;
 		g_main_loop_quit(g_context.main_loop);
@@ -1056,6 +1351,9 @@ int main(int argc, char *argv[])
 
 	rsu_log_init(argv[0]);
 	rsu_settings_new(&g_context.settings);
+	prv_apply_settings(g_context.settings);
+	rsu_settings_set_changed_cb(g_context.settings, prv_settings_changed_cb,
+				    NULL);
 
 	g_set_prgname(PRG_NAME);
 
@@ -71,7 +71,7 @@ void rsu_service_task_add(const rsu_task_queue_key_t *queue_id,
 		g_object_add_weak_pointer((G_OBJECT(proxy)),
 					  (gpointer *)&task->proxy);
 
-	rsu_task_queue_add_task(queue_id, &task->base);
+	(void) rsu_task_queue_add_task(queue_id, &task->base);
 }
 
 void rsu_service_task_begin_action_cb(GUPnPServiceProxy *proxy,
@@ -83,7 +83,7 @@ void rsu_service_task_begin_action_cb(GUPnPServiceProxy *proxy,
 	task->p_action = NULL;
 	task->callback(proxy, action, task->user_data);
 
-	rsu_task_queue_task_completed(task->base.queue_id);
+	rsu_task_queue_task_completed(&task->base);
 }
 
 void rsu_service_task_process_cb(rsu_task_atom_t *atom, gpointer user_data)
@@ -96,7 +96,7 @@ void rsu_service_task_process_cb(rsu_task_atom_t *atom, gpointer user_data)
 	if (failed)
 		rsu_task_processor_cancel_queue(task->base.queue_id);
 	else if (!task->p_action)
-		rsu_task_queue_task_completed(task->base.queue_id);
+		rsu_task_queue_task_completed(&task->base);
 }
 
 void rsu_service_task_cancel_cb(rsu_task_atom_t *atom, gpointer user_data)
@@ -109,7 +109,7 @@ void rsu_service_task_cancel_cb(rsu_task_atom_t *atom, gpointer user_data)
 							  task->p_action);
 		task->p_action = NULL;
 
-		rsu_task_queue_task_completed(task->base.queue_id);
+		rsu_task_queue_task_completed(&task->base);
 	}
 }
 
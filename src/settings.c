@@ -29,9 +29,20 @@ struct rsu_settings_context_t_ {
 	GFileMonitor *monitor;
 	gulong handler_id;
 	guint ev_id;
+	rsu_settings_changed_cb_t changed_cb;
+	gpointer changed_data;
 
 	/* Global section */
 	gboolean never_quit;
+	guint max_tasks_per_renderer;
+	guint pipeline_depth;
+	guint dispatch_budget;
+	gboolean coalesce_tasks;
+	guint task_timeout;
+	guint max_queued_tasks;
+	guint max_queued_tasks_per_client;
+	guint position_resync_interval;
+	guint properties_changed_window;
 
 	/* Log section */
 	rsu_log_type_t log_type;
@@ -42,12 +53,33 @@ struct rsu_settings_context_t_ {
 
 #define RSU_SETTINGS_GROUP_GENERAL	"general"
 #define RSU_SETTINGS_KEY_NEVER_QUIT	"never-quit"
+#define RSU_SETTINGS_KEY_MAX_TASKS	"max-tasks-per-renderer"
+#define RSU_SETTINGS_KEY_PIPELINE_DEPTH	"pipeline-depth"
+#define RSU_SETTINGS_KEY_DISPATCH_BUDGET	"dispatch-budget"
+#define RSU_SETTINGS_KEY_COALESCE_TASKS	"coalesce-tasks"
+#define RSU_SETTINGS_KEY_TASK_TIMEOUT	"task-timeout"
+#define RSU_SETTINGS_KEY_MAX_QUEUED	"max-queued-tasks"
+#define RSU_SETTINGS_KEY_MAX_QUEUED_PER_CLIENT	"max-queued-tasks-per-client"
+#define RSU_SETTINGS_KEY_POSITION_RESYNC	"position-resync-interval"
+#define RSU_SETTINGS_KEY_CHANGES_WINDOW	"properties-changed-window"
+
+#define RSU_SETTINGS_GROUP_CLIENT_WEIGHTS	"client-weights"
 
 #define RSU_SETTINGS_GROUP_LOG		"log"
 #define RSU_SETTINGS_KEY_LOG_TYPE	"log-type"
 #define RSU_SETTINGS_KEY_LOG_LEVEL	"log-level"
 
 #define RSU_SETTINGS_DEFAULT_NEVER_QUIT	RSU_NEVER_QUIT
+#define RSU_SETTINGS_DEFAULT_MAX_TASKS	0
+#define RSU_SETTINGS_DEFAULT_PIPELINE_DEPTH	1
+#define RSU_SETTINGS_DEFAULT_DISPATCH_BUDGET	32
+#define RSU_SETTINGS_DEFAULT_COALESCE_TASKS	FALSE
+#define RSU_SETTINGS_DEFAULT_TASK_TIMEOUT	30
+#define RSU_SETTINGS_DEFAULT_MAX_QUEUED	1024
+#define RSU_SETTINGS_DEFAULT_MAX_QUEUED_PER_CLIENT	128
+#define RSU_SETTINGS_DEFAULT_POSITION_RESYNC	5
+#define RSU_SETTINGS_DEFAULT_CHANGES_WINDOW	30
+#define RSU_SETTINGS_DEFAULT_CLIENT_WEIGHT	1
 #define RSU_SETTINGS_DEFAULT_LOG_TYPE	RSU_LOG_TYPE
 #define RSU_SETTINGS_DEFAULT_LOG_LEVEL	RSU_LOG_LEVEL
 
@@ -58,6 +90,20 @@ do { \
 	RSU_LOG_DEBUG_NL(); \
 	RSU_LOG_DEBUG("[General settings]"); \
 	RSU_LOG_DEBUG("Never Quit: %s", (settings)->never_quit ? "T" : "F"); \
+	RSU_LOG_DEBUG("Max Tasks Per Renderer: %u", \
+		      (settings)->max_tasks_per_renderer); \
+	RSU_LOG_DEBUG("Pipeline Depth: %u", (settings)->pipeline_depth); \
+	RSU_LOG_DEBUG("Dispatch Budget: %u", (settings)->dispatch_budget); \
+	RSU_LOG_DEBUG("Coalesce Tasks: %s", \
+		      (settings)->coalesce_tasks ? "T" : "F"); \
+	RSU_LOG_DEBUG("Task Timeout: %u", (settings)->task_timeout); \
+	RSU_LOG_DEBUG("Max Queued Tasks: %u", (settings)->max_queued_tasks); \
+	RSU_LOG_DEBUG("Max Queued Tasks Per Client: %u", \
+		      (settings)->max_queued_tasks_per_client); \
+	RSU_LOG_DEBUG("Position Resync Interval: %u", \
+		      (settings)->position_resync_interval); \
+	RSU_LOG_DEBUG("Properties Changed Window: %u", \
+		      (settings)->properties_changed_window); \
 	RSU_LOG_DEBUG_NL(); \
 	RSU_LOG_DEBUG("[Logging settings]"); \
 	RSU_LOG_DEBUG("Log Type : %d", (settings)->log_type); \
@@ -205,6 +251,105 @@ static void prv_rsu_settings_read_keys(rsu_settings_context_t *settings)
 		error = NULL;
 	}
 
+	int_val = g_key_file_get_integer(keyfile, RSU_SETTINGS_GROUP_GENERAL,
+						  RSU_SETTINGS_KEY_MAX_TASKS,
+						  &error);
+
+	if (error == NULL) {
+		settings->max_tasks_per_renderer = MAX(int_val, 0);
+	} else {
+		g_error_free(error);
+		error = NULL;
+	}
+
+	int_val = g_key_file_get_integer(keyfile, RSU_SETTINGS_GROUP_GENERAL,
+					 RSU_SETTINGS_KEY_PIPELINE_DEPTH,
+					 &error);
+
+	if (error == NULL) {
+		settings->pipeline_depth = MAX(int_val, 1);
+	} else {
+		g_error_free(error);
+		error = NULL;
+	}
+
+	int_val = g_key_file_get_integer(keyfile, RSU_SETTINGS_GROUP_GENERAL,
+					 RSU_SETTINGS_KEY_DISPATCH_BUDGET,
+					 &error);
+
+	if (error == NULL) {
+		settings->dispatch_budget = MAX(int_val, 0);
+	} else {
+		g_error_free(error);
+		error = NULL;
+	}
+
+	b_val = g_key_file_get_boolean(keyfile, RSU_SETTINGS_GROUP_GENERAL,
+						RSU_SETTINGS_KEY_COALESCE_TASKS,
+						&error);
+
+	if (error == NULL) {
+		settings->coalesce_tasks = b_val;
+	} else {
+		g_error_free(error);
+		error = NULL;
+	}
+
+	int_val = g_key_file_get_integer(keyfile, RSU_SETTINGS_GROUP_GENERAL,
+					 RSU_SETTINGS_KEY_TASK_TIMEOUT,
+					 &error);
+
+	if (error == NULL) {
+		settings->task_timeout = MAX(int_val, 0);
+	} else {
+		g_error_free(error);
+		error = NULL;
+	}
+
+	int_val = g_key_file_get_integer(keyfile, RSU_SETTINGS_GROUP_GENERAL,
+					 RSU_SETTINGS_KEY_MAX_QUEUED,
+					 &error);
+
+	if (error == NULL) {
+		settings->max_queued_tasks = MAX(int_val, 0);
+	} else {
+		g_error_free(error);
+		error = NULL;
+	}
+
+	int_val = g_key_file_get_integer(keyfile, RSU_SETTINGS_GROUP_GENERAL,
+					 RSU_SETTINGS_KEY_MAX_QUEUED_PER_CLIENT,
+					 &error);
+
+	if (error == NULL) {
+		settings->max_queued_tasks_per_client = MAX(int_val, 0);
+	} else {
+		g_error_free(error);
+		error = NULL;
+	}
+
+	int_val = g_key_file_get_integer(keyfile, RSU_SETTINGS_GROUP_GENERAL,
+					 RSU_SETTINGS_KEY_POSITION_RESYNC,
+					 &error);
+
+	if (error == NULL) {
+		settings->position_resync_interval = MAX(int_val, 0);
+	} else {
+		g_error_free(error);
+		error = NULL;
+	}
+
+	int_val = g_key_file_get_integer(keyfile, RSU_SETTINGS_GROUP_GENERAL,
+					 RSU_SETTINGS_KEY_CHANGES_WINDOW,
+					 &error);
+
+	if (error == NULL) {
+		settings->properties_changed_window = MAX(int_val, 0);
+	} else {
+		g_error_free(error);
+		error = NULL;
+	}
+
 	int_val = g_key_file_get_integer(keyfile, RSU_SETTINGS_GROUP_LOG,
 						  RSU_SETTINGS_KEY_LOG_TYPE,
 						  &error);
@@ -236,6 +381,18 @@ static void prv_rsu_settings_read_keys(rsu_settings_context_t *settings)
 static void prv_rsu_settings_init_default(rsu_settings_context_t *settings)
 {
 	settings->never_quit = RSU_SETTINGS_DEFAULT_NEVER_QUIT;
+	settings->max_tasks_per_renderer = RSU_SETTINGS_DEFAULT_MAX_TASKS;
+	settings->pipeline_depth = RSU_SETTINGS_DEFAULT_PIPELINE_DEPTH;
+	settings->dispatch_budget = RSU_SETTINGS_DEFAULT_DISPATCH_BUDGET;
+	settings->coalesce_tasks = RSU_SETTINGS_DEFAULT_COALESCE_TASKS;
+	settings->task_timeout = RSU_SETTINGS_DEFAULT_TASK_TIMEOUT;
+	settings->max_queued_tasks = RSU_SETTINGS_DEFAULT_MAX_QUEUED;
+	settings->max_queued_tasks_per_client =
+				RSU_SETTINGS_DEFAULT_MAX_QUEUED_PER_CLIENT;
+	settings->position_resync_interval =
+				RSU_SETTINGS_DEFAULT_POSITION_RESYNC;
+	settings->properties_changed_window =
+				RSU_SETTINGS_DEFAULT_CHANGES_WINDOW;
 
 	settings->log_type = RSU_SETTINGS_DEFAULT_LOG_TYPE;
 	settings->log_level = RSU_SETTINGS_DEFAULT_LOG_LEVEL;
@@ -293,6 +450,9 @@ static gboolean prv_rsu_settings_monitor_timout_cb(gpointer user_data)
 
 	prv_rsu_settings_reload(data);
 
+	if (data->changed_cb)
+		data->changed_cb(data, data->changed_data);
+
 	data->ev_id = 0;
 	return FALSE;
 }
@@ -346,11 +506,96 @@ static void prv_rsu_settings_monitor_local_keyfile(
 	}
 }
 
+void rsu_settings_set_changed_cb(rsu_settings_context_t *settings,
+				 rsu_settings_changed_cb_t cb,
+				 gpointer user_data)
+{
+	settings->changed_cb = cb;
+	settings->changed_data = user_data;
+}
+
 gboolean rsu_settings_is_never_quit(rsu_settings_context_t *settings)
 {
 	return settings->never_quit;
 }
 
+guint rsu_settings_get_max_tasks_per_renderer(
+					rsu_settings_context_t *settings)
+{
+	return settings->max_tasks_per_renderer;
+}
+
+guint rsu_settings_get_pipeline_depth(rsu_settings_context_t *settings)
+{
+	return settings->pipeline_depth;
+}
+
+guint rsu_settings_get_dispatch_budget(rsu_settings_context_t *settings)
+{
+	return settings->dispatch_budget;
+}
+
+gboolean rsu_settings_is_coalesce_tasks(rsu_settings_context_t *settings)
+{
+	return settings->coalesce_tasks;
+}
+
+guint rsu_settings_get_task_timeout(rsu_settings_context_t *settings)
+{
+	return settings->task_timeout;
+}
+
+guint rsu_settings_get_max_queued_tasks(rsu_settings_context_t *settings)
+{
+	return settings->max_queued_tasks;
+}
+
+guint rsu_settings_get_max_queued_tasks_per_client(
+					rsu_settings_context_t *settings)
+{
+	return settings->max_queued_tasks_per_client;
+}
+
+guint rsu_settings_get_position_resync_interval(
+					rsu_settings_context_t *settings)
+{
+	return settings->position_resync_interval;
+}
+
+guint rsu_settings_get_properties_changed_window(
+					rsu_settings_context_t *settings)
+{
+	return settings->properties_changed_window;
+}
+
+gboolean rsu_settings_has_client_weights(rsu_settings_context_t *settings)
+{
+	return settings->keyfile &&
+		g_key_file_has_group(settings->keyfile,
+				     RSU_SETTINGS_GROUP_CLIENT_WEIGHTS);
+}
+
+guint rsu_settings_get_client_weight(rsu_settings_context_t *settings,
+				     const gchar *program)
+{
+	GError *error = NULL;
+	gint int_val;
+
+	if (!settings->keyfile)
+		return RSU_SETTINGS_DEFAULT_CLIENT_WEIGHT;
+
+	int_val = g_key_file_get_integer(settings->keyfile,
+					 RSU_SETTINGS_GROUP_CLIENT_WEIGHTS,
+					 program, &error);
+
+	if (error != NULL) {
+		g_error_free(error);
+		return RSU_SETTINGS_DEFAULT_CLIENT_WEIGHT;
+	}
+
+	return MAX(int_val, 1);
+}
+
 void rsu_settings_new(rsu_settings_context_t **settings)
 {
 	gchar *sys_path = NULL;
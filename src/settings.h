@@ -30,9 +30,32 @@
 
 typedef struct rsu_settings_context_t_ rsu_settings_context_t;
 
+/* Called once the configuration file has been read again after a change */
+typedef void (*rsu_settings_changed_cb_t)(rsu_settings_context_t *settings,
+					  gpointer user_data);
+
 void rsu_settings_new(rsu_settings_context_t **settings);
 void rsu_settings_delete(rsu_settings_context_t *settings);
+void rsu_settings_set_changed_cb(rsu_settings_context_t *settings,
+				 rsu_settings_changed_cb_t cb,
+				 gpointer user_data);
 
 gboolean rsu_settings_is_never_quit(rsu_settings_context_t *settings);
+guint rsu_settings_get_max_tasks_per_renderer(
+					rsu_settings_context_t *settings);
+guint rsu_settings_get_pipeline_depth(rsu_settings_context_t *settings);
+guint rsu_settings_get_dispatch_budget(rsu_settings_context_t *settings);
+gboolean rsu_settings_is_coalesce_tasks(rsu_settings_context_t *settings);
+guint rsu_settings_get_task_timeout(rsu_settings_context_t *settings);
+guint rsu_settings_get_max_queued_tasks(rsu_settings_context_t *settings);
+guint rsu_settings_get_max_queued_tasks_per_client(
+					rsu_settings_context_t *settings);
+guint rsu_settings_get_position_resync_interval(
+					rsu_settings_context_t *settings);
+guint rsu_settings_get_properties_changed_window(
+					rsu_settings_context_t *settings);
+gboolean rsu_settings_has_client_weights(rsu_settings_context_t *settings);
+guint rsu_settings_get_client_weight(rsu_settings_context_t *settings,
+				     const gchar *program);
 
 #endif /* RSU_SETTINGS_H__ */
@@ -0,0 +1,277 @@
+/*
+ * renderer-service-upnp
+ *
+ * Copyright (C) 2013 Intel Corporation. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU Lesser General Public License,
+ * version 2.1, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St - Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include "stats.h"
+
+/* Durations, in microseconds, are counted in log-linear histograms.
+ * Values below 16 have a bucket each.  Above, every power of two is split
+ * in 8 linear buckets, so a bucket never spans more than 1/8th of the
+ * values it holds.  Values are clamped to G_MAXUINT32, a bit more than
+ * an hour, which gives 240 buckets. */
+
+#define RSU_STATS_SUB_BITS 3
+#define RSU_STATS_SUB_BUCKETS (1 << RSU_STATS_SUB_BITS)
+#define RSU_STATS_BUCKETS ((32 - RSU_STATS_SUB_BITS) * RSU_STATS_SUB_BUCKETS \
+			   + RSU_STATS_SUB_BUCKETS)
+
+typedef struct rsu_stats_histogram_t_ rsu_stats_histogram_t;
+struct rsu_stats_histogram_t_ {
+	guint64 count;
+	guint64 sum;
+	guint64 max;
+	guint64 buckets[RSU_STATS_BUCKETS];
+};
+
+typedef struct rsu_stats_timing_t_ rsu_stats_timing_t;
+struct rsu_stats_timing_t_ {
+	rsu_stats_histogram_t wait;
+	rsu_stats_histogram_t service;
+};
+
+struct rsu_stats_t_ {
+	rsu_stats_histogram_t dispatch;
+	GHashTable *tasks;
+	GHashTable *sinks;
+};
+
+static guint prv_histogram_index(guint64 value)
+{
+	guint bits;
+
+	if (value < 2 * RSU_STATS_SUB_BUCKETS)
+		return value;
+
+	bits = g_bit_storage(value) - RSU_STATS_SUB_BITS - 1;
+
+	return bits * RSU_STATS_SUB_BUCKETS + (value >> bits);
+}
+
+static guint64 prv_histogram_lower(guint index)
+{
+	guint shift;
+
+	if (index < 2 * RSU_STATS_SUB_BUCKETS)
+		return index;
+
+	shift = index / RSU_STATS_SUB_BUCKETS - 1;
+
+	return (guint64)(index % RSU_STATS_SUB_BUCKETS +
+			 RSU_STATS_SUB_BUCKETS) << shift;
+}
+
+static guint64 prv_histogram_upper(guint index)
+{
+	if (index + 1 == RSU_STATS_BUCKETS)
+		return G_MAXUINT32;
+
+	return prv_histogram_lower(index + 1) - 1;
+}
+
+static void prv_histogram_record(rsu_stats_histogram_t *histogram,
+				 guint64 value)
+{
+	value = MIN(value, G_MAXUINT32);
+
+	histogram->count++;
+	histogram->sum += value;
+	if (value > histogram->max)
+		histogram->max = value;
+	histogram->buckets[prv_histogram_index(value)]++;
+}
+
+/* Returns the highest value of the bucket holding the given percentile,
+ * which over-estimates it by at most one bucket width. */
+
+static guint64 prv_histogram_percentile(
+				const rsu_stats_histogram_t *histogram,
+				guint percentile)
+{
+	guint64 rank;
+	guint64 seen = 0;
+	guint i;
+
+	if (!histogram->count)
+		return 0;
+
+	rank = (histogram->count * percentile + 99) / 100;
+
+	for (i = 0; i < RSU_STATS_BUCKETS; ++i) {
+		seen += histogram->buckets[i];
+		if (seen >= rank)
+			break;
+	}
+
+	return MIN(prv_histogram_upper(i), histogram->max);
+}
+
+static GVariant *prv_histogram_to_variant(
+				const rsu_stats_histogram_t *histogram)
+{
+	GVariantBuilder vb;
+	GVariantBuilder buckets_vb;
+	guint i;
+
+	g_variant_builder_init(&buckets_vb, G_VARIANT_TYPE("a(tt)"));
+
+	for (i = 0; i < RSU_STATS_BUCKETS; ++i)
+		if (histogram->buckets[i])
+			g_variant_builder_add(&buckets_vb, "(tt)",
+					      prv_histogram_lower(i),
+					      histogram->buckets[i]);
+
+	g_variant_builder_init(&vb, G_VARIANT_TYPE("a{sv}"));
+	g_variant_builder_add(&vb, "{sv}", "Count",
+			      g_variant_new_uint64(histogram->count));
+	g_variant_builder_add(&vb, "{sv}", "Sum",
+			      g_variant_new_uint64(histogram->sum));
+	g_variant_builder_add(&vb, "{sv}", "Max",
+			      g_variant_new_uint64(histogram->max));
+	g_variant_builder_add(&vb, "{sv}", "P50",
+			      g_variant_new_uint64(
+				prv_histogram_percentile(histogram, 50)));
+	g_variant_builder_add(&vb, "{sv}", "P90",
+			      g_variant_new_uint64(
+				prv_histogram_percentile(histogram, 90)));
+	g_variant_builder_add(&vb, "{sv}", "P99",
+			      g_variant_new_uint64(
+				prv_histogram_percentile(histogram, 99)));
+	g_variant_builder_add(&vb, "{sv}", "Buckets",
+			      g_variant_builder_end(&buckets_vb));
+
+	return g_variant_builder_end(&vb);
+}
+
+static void prv_timing_add(const rsu_stats_timing_t *timing,
+			   GVariantBuilder *vb)
+{
+	g_variant_builder_add(vb, "{sv}", "Wait",
+			      prv_histogram_to_variant(&timing->wait));
+	g_variant_builder_add(vb, "{sv}", "Service",
+			      prv_histogram_to_variant(&timing->service));
+}
+
+static rsu_stats_timing_t *prv_timing_lookup(GHashTable *table,
+					     const gchar *key)
+{
+	rsu_stats_timing_t *timing;
+
+	timing = g_hash_table_lookup(table, key);
+
+	if (!timing) {
+		timing = g_new0(rsu_stats_timing_t, 1);
+		g_hash_table_insert(table, g_strdup(key), timing);
+	}
+
+	return timing;
+}
+
+rsu_stats_t *rsu_stats_new(void)
+{
+	rsu_stats_t *stats;
+
+	stats = g_new0(rsu_stats_t, 1);
+	stats->tasks = g_hash_table_new_full(g_str_hash, g_str_equal,
+					     g_free, g_free);
+	stats->sinks = g_hash_table_new_full(g_str_hash, g_str_equal,
+					     g_free, g_free);
+
+	return stats;
+}
+
+void rsu_stats_free(rsu_stats_t *stats)
+{
+	g_hash_table_unref(stats->tasks);
+	g_hash_table_unref(stats->sinks);
+	g_free(stats);
+}
+
+void rsu_stats_record_dispatch(rsu_stats_t *stats, guint64 delay)
+{
+	prv_histogram_record(&stats->dispatch, delay);
+}
+
+void rsu_stats_record_task(rsu_stats_t *stats, const gchar *sink,
+			   const gchar *name, guint64 wait, guint64 service)
+{
+	rsu_stats_timing_t *timing;
+
+	timing = prv_timing_lookup(stats->tasks, name);
+	prv_histogram_record(&timing->wait, wait);
+	prv_histogram_record(&timing->service, service);
+
+	timing = prv_timing_lookup(stats->sinks, sink);
+	prv_histogram_record(&timing->wait, wait);
+	prv_histogram_record(&timing->service, service);
+}
+
+void rsu_stats_remove_sink(rsu_stats_t *stats, const gchar *sink)
+{
+	(void) g_hash_table_remove(stats->sinks, sink);
+}
+
+GVariant *rsu_stats_dispatch_to_variant(rsu_stats_t *stats)
+{
+	return prv_histogram_to_variant(&stats->dispatch);
+}
+
+GVariant *rsu_stats_tasks_to_variant(rsu_stats_t *stats)
+{
+	GVariantBuilder vb;
+	GVariantBuilder task_vb;
+	GHashTableIter iter;
+	gpointer key;
+	gpointer value;
+
+	g_variant_builder_init(&vb, G_VARIANT_TYPE("a{sa{sv}}"));
+	g_hash_table_iter_init(&iter, stats->tasks);
+
+	while (g_hash_table_iter_next(&iter, &key, &value)) {
+		g_variant_builder_init(&task_vb, G_VARIANT_TYPE("a{sv}"));
+		prv_timing_add(value, &task_vb);
+		g_variant_builder_add(&vb, "{s@a{sv}}", key,
+				      g_variant_builder_end(&task_vb));
+	}
+
+	return g_variant_builder_end(&vb);
+}
+
+GVariant *rsu_stats_sinks_to_variant(rsu_stats_t *stats,
+				     rsu_stats_gauge_cb_t gauge_cb,
+				     gpointer user_data)
+{
+	GVariantBuilder vb;
+	GVariantBuilder sink_vb;
+	GHashTableIter iter;
+	gpointer key;
+	gpointer value;
+
+	g_variant_builder_init(&vb, G_VARIANT_TYPE("a{sa{sv}}"));
+	g_hash_table_iter_init(&iter, stats->sinks);
+
+	while (g_hash_table_iter_next(&iter, &key, &value)) {
+		g_variant_builder_init(&sink_vb, G_VARIANT_TYPE("a{sv}"));
+		gauge_cb(key, &sink_vb, user_data);
+		prv_timing_add(value, &sink_vb);
+		g_variant_builder_add(&vb, "{s@a{sv}}", key,
+				      g_variant_builder_end(&sink_vb));
+	}
+
+	return g_variant_builder_end(&vb);
+}
@@ -0,0 +1,43 @@
+/*
+ * renderer-service-upnp
+ *
+ * Copyright (C) 2013 Intel Corporation. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU Lesser General Public License,
+ * version 2.1, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St - Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ */
+
+#ifndef RSU_STATS_H__
+#define RSU_STATS_H__
+
+#include <glib.h>
+
+typedef struct rsu_stats_t_ rsu_stats_t;
+
+typedef void (*rsu_stats_gauge_cb_t)(const gchar *sink, GVariantBuilder *vb,
+				     gpointer user_data);
+
+rsu_stats_t *rsu_stats_new(void);
+void rsu_stats_free(rsu_stats_t *stats);
+void rsu_stats_record_dispatch(rsu_stats_t *stats, guint64 delay);
+void rsu_stats_record_task(rsu_stats_t *stats, const gchar *sink,
+			   const gchar *name, guint64 wait, guint64 service);
+void rsu_stats_remove_sink(rsu_stats_t *stats, const gchar *sink);
+GVariant *rsu_stats_dispatch_to_variant(rsu_stats_t *stats);
+GVariant *rsu_stats_tasks_to_variant(rsu_stats_t *stats);
+GVariant *rsu_stats_sinks_to_variant(rsu_stats_t *stats,
+				     rsu_stats_gauge_cb_t gauge_cb,
+				     gpointer user_data);
+
+#endif /* RSU_STATS_H__ */
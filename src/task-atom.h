@@ -23,11 +23,31 @@
 #ifndef RSU_TASK_ATOM_H__
 #define RSU_TASK_ATOM_H__
 
+#include <glib.h>
+
 typedef struct rsu_task_queue_key_t_ rsu_task_queue_key_t;
 
+enum rsu_task_priority_t_ {
+	RSU_TASK_PRIORITY_READ,
+	RSU_TASK_PRIORITY_CONTROL,
+	RSU_TASK_PRIORITY_TRANSPORT,
+	RSU_TASK_PRIORITY_COUNT
+};
+typedef enum rsu_task_priority_t_ rsu_task_priority_t;
+
 typedef struct rsu_task_atom_t_ rsu_task_atom_t;
 struct rsu_task_atom_t_ {
 	const rsu_task_queue_key_t *queue_id;
+	const gchar *name;
+	gboolean read_only;
+	rsu_task_priority_t priority;
+	guint coalesce_id;
+	guint timeout;
+	gint64 queued_time;
+	gint64 start_time;
+	gint64 deadline;
+	gboolean timed_out;
+	GList link;
 };
 
 #endif /* RSU_TASK_ATOM_H__ */
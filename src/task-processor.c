@@ -25,27 +25,114 @@
 
 #include "task-processor.h"
 #include "log.h"
+#include "stats.h"
+
+/* Deferred calls are run by the processor dispatcher, in FIFO order.
+ * Queues embed the call used to process their next task, other calls
+ * are allocated by rsu_task_processor_defer(). */
+
+typedef struct rsu_task_call_t_ rsu_task_call_t;
+struct rsu_task_call_t_ {
+	GList link;
+	GSourceFunc func;
+	gpointer data;
+	gint64 push_time;
+	gboolean pending;
+	gboolean allocated;
+};
+
+/* Running tasks that have a deadline are kept in a timer wheel with one
+ * slot per second.  They are chained through the link embedded in their
+ * atom, which is unused once a task is running.  A task is put in the
+ * slot of its deadline modulo the size of the wheel, so a slot can hold
+ * tasks expiring on a later turn.  The wheel only ticks while it holds
+ * tasks. */
+
+#define RSU_TASK_WHEEL_SLOTS 64
+
+/* Virtual time a queue of weight 1 consumes per task granted a sink slot.
+ * A queue of weight w consumes RSU_TASK_WEIGHT_SCALE / w. */
+
+#define RSU_TASK_WEIGHT_SCALE 65536
+
+typedef struct rsu_task_dispatcher_t_ rsu_task_dispatcher_t;
+struct rsu_task_dispatcher_t_ {
+	GSource source;
+	rsu_task_processor_t *processor;
+};
 
 struct rsu_task_processor_t_ {
+	rsu_task_wait_stats_t wait_stats[RSU_TASK_PRIORITY_COUNT];
+	rsu_stats_t *stats;
+	GSource *dispatcher;
+	GQueue calls;
+	guint dispatch_budget;
 	GHashTable *task_queues;
+	GHashTable *task_sinks;
+	GHashTable *source_index;
+	GHashTable *sink_index;
+	GHashTable *source_weights;
 	guint running_tasks;
+	guint queued_tasks;
+	guint64 refused_tasks;
+	guint max_queued;
+	guint max_queued_per_source;
+	guint max_tasks_per_sink;
+	guint pipeline_depth;
 	gboolean quitting;
 	GSourceFunc on_quit_cb;
+	GQueue timeout_wheel[RSU_TASK_WHEEL_SLOTS];
+	gint64 timeout_tick;
+	guint timeout_armed;
+	guint timeout_id;
+	guint task_timeout;
+	guint64 timeouts[RSU_TASK_PRIORITY_COUNT];
+};
+
+/* Shared by all the RSU_TASK_QUEUE_FLAG_LIMIT_SINK queues targeting the
+ * same sink.  running_tasks counts the tasks that are either running or
+ * scheduled to run on the sink.  Queues that could not get a slot wait
+ * in waiting_queues.
+ *
+ * Free slots are shared between the waiting queues by self-clocked fair
+ * queuing.  A queue that starts waiting is given a finish tag, which is
+ * the later of the sink virtual time and its previous finish tag, plus
+ * the cost of a task for its weight.  Slots go to the waiting queue with
+ * the smallest tag, and the sink virtual time moves to that tag.  A queue
+ * of weight 2 thus gets twice as many slots as a queue of weight 1 when
+ * both are busy.  Queues of equal weight are served in FIFO order. */
+
+typedef struct rsu_task_sink_t_ rsu_task_sink_t;
+struct rsu_task_sink_t_ {
+	rsu_task_processor_t *processor;
+	gchar *name;
+	guint ref_count;
+	guint running_tasks;
+	guint64 virtual_time;
+	GQueue waiting_queues;
 };
 
 typedef struct rsu_task_queue_t_ rsu_task_queue_t;
 struct rsu_task_queue_t_ {
-	GPtrArray *tasks;
+	GQueue tasks[RSU_TASK_PRIORITY_COUNT];
+	guint task_count;
 	rsu_task_process_cb_t task_process_cb;
 	rsu_task_cancel_cb_t task_cancel_cb;
 	rsu_task_delete_cb_t task_delete_cb;
 	rsu_task_finally_cb_t task_queue_finally_cb;
-	rsu_task_atom_t *current_task;
-	guint idle_id;
+	rsu_task_coalesce_cb_t task_coalesce_cb;
+	GPtrArray *running;
+	rsu_task_call_t process_call;
 	gboolean defer_remove;
 	guint32 flags;
 	gpointer user_data;
 	gboolean cancelled;
+	const rsu_task_queue_key_t *id;
+	rsu_task_sink_t *sink;
+	gboolean waiting;
+	guint weight;
+	guint64 finish_tag;
+	rsu_task_processor_t *processor;
 };
 
 struct rsu_task_queue_key_t_ {
@@ -54,6 +141,86 @@ struct rsu_task_queue_key_t_ {
 	gchar *sink;
 };
 
+static void prv_call_push(rsu_task_processor_t *processor,
+			  rsu_task_call_t *call)
+{
+	call->link.data = call;
+	call->link.prev = NULL;
+	call->link.next = NULL;
+	call->push_time = g_get_monotonic_time();
+	call->pending = TRUE;
+	g_queue_push_tail_link(&processor->calls, &call->link);
+}
+
+static void prv_call_remove(rsu_task_processor_t *processor,
+			    rsu_task_call_t *call)
+{
+	if (call->pending) {
+		g_queue_unlink(&processor->calls, &call->link);
+		call->pending = FALSE;
+	}
+}
+
+static gboolean prv_dispatcher_prepare(GSource *source, gint *timeout)
+{
+	rsu_task_processor_t *processor =
+				((rsu_task_dispatcher_t *)source)->processor;
+
+	*timeout = -1;
+
+	return !g_queue_is_empty(&processor->calls);
+}
+
+static gboolean prv_dispatcher_check(GSource *source)
+{
+	rsu_task_processor_t *processor =
+				((rsu_task_dispatcher_t *)source)->processor;
+
+	return !g_queue_is_empty(&processor->calls);
+}
+
+static gboolean prv_dispatcher_dispatch(GSource *source, GSourceFunc callback,
+					gpointer user_data)
+{
+	rsu_task_processor_t *processor =
+				((rsu_task_dispatcher_t *)source)->processor;
+	rsu_task_call_t *call;
+	GSourceFunc func;
+	gpointer data;
+	guint count = 0;
+
+	/* Calls left over when the budget is exhausted are run on the next
+	   main loop iteration, giving other sources a chance to run. */
+
+	while (!g_queue_is_empty(&processor->calls)) {
+		if (processor->dispatch_budget &&
+		    count++ == processor->dispatch_budget)
+			break;
+
+		call = g_queue_pop_head_link(&processor->calls)->data;
+		call->pending = FALSE;
+		func = call->func;
+		data = call->data;
+		rsu_stats_record_dispatch(processor->stats,
+					  g_get_monotonic_time() -
+					  call->push_time);
+
+		if (call->allocated)
+			g_slice_free(rsu_task_call_t, call);
+
+		(void) func(data);
+	}
+
+	return TRUE;
+}
+
+static GSourceFuncs g_dispatcher_funcs = {
+	prv_dispatcher_prepare,
+	prv_dispatcher_check,
+	prv_dispatcher_dispatch,
+	NULL
+};
+
 static guint prv_task_queue_key_hash_cb(gconstpointer ptr)
 {
 	const rsu_task_queue_key_t *queue_key = ptr;
@@ -75,20 +242,349 @@ static gboolean prv_task_queue_key_equal_cb(gconstpointer ptr1,
 		!strcmp(queue_key1->sink, queue_key2->sink);
 }
 
+/* The source and sink indices map a source (resp. sink) name to the
+ * array of the keys of the queues using it. */
+
+static void prv_task_queue_index_add(GHashTable *index, const gchar *name,
+				     rsu_task_queue_key_t *queue_key)
+{
+	GPtrArray *keys;
+
+	keys = g_hash_table_lookup(index, name);
+
+	if (!keys) {
+		keys = g_ptr_array_new();
+		g_hash_table_insert(index, g_strdup(name), keys);
+	}
+
+	g_ptr_array_add(keys, queue_key);
+}
+
+static void prv_task_queue_index_remove(GHashTable *index, const gchar *name,
+					rsu_task_queue_key_t *queue_key)
+{
+	GPtrArray *keys;
+
+	keys = g_hash_table_lookup(index, name);
+
+	if (keys) {
+		(void) g_ptr_array_remove_fast(keys, queue_key);
+		if (keys->len == 0)
+			(void) g_hash_table_remove(index, name);
+	}
+}
+
+static void prv_task_queue_index_free_cb(gpointer data)
+{
+	g_ptr_array_unref(data);
+}
+
 static void prv_task_queue_key_free_cb(gpointer ptr)
 {
 	rsu_task_queue_key_t *queue_key = ptr;
 
+	prv_task_queue_index_remove(queue_key->processor->source_index,
+				    queue_key->source, queue_key);
+	prv_task_queue_index_remove(queue_key->processor->sink_index,
+				    queue_key->sink, queue_key);
+
 	g_free(queue_key->source);
 	g_free(queue_key->sink);
 	g_free(queue_key);
 }
 
-static void prv_task_free_cb(gpointer data, gpointer user_data)
+static void prv_task_sink_free_cb(gpointer data)
+{
+	rsu_task_sink_t *sink = data;
+
+	g_queue_clear(&sink->waiting_queues);
+	g_free(sink);
+}
+
+static rsu_task_sink_t *prv_task_sink_ref(rsu_task_processor_t *processor,
+					  const gchar *name)
+{
+	rsu_task_sink_t *sink;
+
+	sink = g_hash_table_lookup(processor->task_sinks, name);
+
+	if (!sink) {
+		sink = g_new0(rsu_task_sink_t, 1);
+		sink->processor = processor;
+		sink->name = g_strdup(name);
+		g_queue_init(&sink->waiting_queues);
+		g_hash_table_insert(processor->task_sinks, sink->name, sink);
+	}
+
+	sink->ref_count++;
+
+	return sink;
+}
+
+static void prv_task_sink_unref(rsu_task_sink_t *sink)
+{
+	if (--sink->ref_count == 0)
+		g_hash_table_remove(sink->processor->task_sinks, sink->name);
+}
+
+/* Pending tasks are chained through the link embedded in their atom, so
+ * adding and removing a task never allocates nor moves other tasks.
+ *
+ * Queues created with RSU_TASK_QUEUE_FLAG_PRIORITY have one lane per
+ * task priority.  Tasks are dispatched from the highest priority lane
+ * that is not empty, and in FIFO order within a lane.  Other queues put
+ * all their tasks in the first lane. */
+
+static GQueue *prv_task_queue_lane(rsu_task_queue_t *queue,
+				   rsu_task_atom_t *task)
+{
+	guint lane = 0;
+
+	if (queue->flags & RSU_TASK_QUEUE_FLAG_PRIORITY)
+		lane = task->priority;
+
+	return &queue->tasks[lane];
+}
+
+static void prv_task_queue_push(rsu_task_queue_t *queue, rsu_task_atom_t *task)
+{
+	task->queued_time = g_get_monotonic_time();
+	task->link.data = task;
+	task->link.prev = NULL;
+	task->link.next = NULL;
+	g_queue_push_tail_link(prv_task_queue_lane(queue, task), &task->link);
+	queue->task_count++;
+
+	if (queue->flags & RSU_TASK_QUEUE_FLAG_BOUNDED)
+		queue->processor->queued_tasks++;
+}
+
+/* A pending task can be superseded by a newer task with the same
+ * coalesce_id, if it is the last task of the lane.  The new task then
+ * takes its place, and never overtakes a task of another kind. */
+
+static gboolean prv_task_queue_coalesce(rsu_task_queue_t *queue,
+					rsu_task_atom_t *task)
+{
+	GQueue *lane;
+	GList *link;
+	rsu_task_atom_t *old_task;
+	gboolean coalesced = FALSE;
+
+	if (!queue->task_coalesce_cb || !task->coalesce_id)
+		goto exit;
+
+	lane = prv_task_queue_lane(queue, task);
+	link = lane->tail;
+
+	if (!link)
+		goto exit;
+
+	old_task = link->data;
+
+	if (old_task->coalesce_id != task->coalesce_id)
+		goto exit;
+
+	coalesced = queue->task_coalesce_cb(old_task, task, queue->user_data);
+	if (!coalesced)
+		goto exit;
+
+	RSU_LOG_DEBUG("Task superseded in queue <%s,%s>",
+		      queue->id->source, queue->id->sink);
+
+	task->queued_time = g_get_monotonic_time();
+	task->link.data = task;
+	task->link.prev = link->prev;
+	task->link.next = link->next;
+
+	if (link->prev)
+		link->prev->next = &task->link;
+	else
+		lane->head = &task->link;
+
+	if (link->next)
+		link->next->prev = &task->link;
+	else
+		lane->tail = &task->link;
+
+	queue->task_delete_cb(old_task, queue->user_data);
+
+exit:
+
+	return coalesced;
+}
+
+static GQueue *prv_task_queue_first_lane(rsu_task_queue_t *queue)
+{
+	guint lane = RSU_TASK_PRIORITY_COUNT;
+
+	while (lane-- > 0)
+		if (!g_queue_is_empty(&queue->tasks[lane]))
+			return &queue->tasks[lane];
+
+	return NULL;
+}
+
+static rsu_task_atom_t *prv_task_queue_peek(rsu_task_queue_t *queue)
+{
+	GQueue *lane = prv_task_queue_first_lane(queue);
+
+	return lane ? g_queue_peek_head(lane) : NULL;
+}
+
+static rsu_task_atom_t *prv_task_queue_pop(rsu_task_queue_t *queue)
+{
+	GQueue *lane = prv_task_queue_first_lane(queue);
+
+	if (!lane)
+		return NULL;
+
+	queue->task_count--;
+
+	if (queue->flags & RSU_TASK_QUEUE_FLAG_BOUNDED)
+		queue->processor->queued_tasks--;
+
+	return g_queue_pop_head_link(lane)->data;
+}
+
+static void prv_task_wait_stats_update(rsu_task_processor_t *processor,
+				       rsu_task_atom_t *task)
+{
+	rsu_task_wait_stats_t *stats = &processor->wait_stats[task->priority];
+	guint64 wait = task->start_time - task->queued_time;
+
+	stats->count++;
+	stats->total_wait += wait;
+	if (wait > stats->max_wait)
+		stats->max_wait = wait;
+
+	RSU_LOG_DEBUG("Task of priority %d waited %" G_GUINT64_FORMAT " us",
+		      task->priority, wait);
+}
+
+static gint64 prv_timeout_second(gint64 deadline)
+{
+	return (deadline + G_USEC_PER_SEC - 1) / G_USEC_PER_SEC;
+}
+
+static GQueue *prv_timeout_slot(rsu_task_processor_t *processor,
+				gint64 second)
+{
+	return &processor->timeout_wheel[second % RSU_TASK_WHEEL_SLOTS];
+}
+
+static void prv_timeout_disarm(rsu_task_processor_t *processor,
+			       rsu_task_atom_t *task)
+{
+	gint64 second;
+
+	if (!task->deadline)
+		return;
+
+	second = prv_timeout_second(task->deadline);
+	g_queue_unlink(prv_timeout_slot(processor, second), &task->link);
+	task->deadline = 0;
+	processor->timeout_armed--;
+}
+
+static rsu_task_atom_t *prv_timeout_next_expired(GQueue *slot, gint64 now)
+{
+	GList *link;
+	rsu_task_atom_t *task;
+
+	for (link = slot->head; link; link = link->next) {
+		task = link->data;
+		if (prv_timeout_second(task->deadline) <= now)
+			return task;
+	}
+
+	return NULL;
+}
+
+static void prv_timeout_expire_slot(rsu_task_processor_t *processor,
+				    GQueue *slot, gint64 now)
+{
+	rsu_task_atom_t *task;
+	rsu_task_queue_t *queue;
+
+	/* Cancelling a task may complete it synchronously, and with it
+	   other tasks of the slot, so the slot is scanned again after each
+	   expiry. */
+
+	while ((task = prv_timeout_next_expired(slot, now))) {
+		prv_timeout_disarm(processor, task);
+		task->timed_out = TRUE;
+		processor->timeouts[task->priority]++;
+
+		RSU_LOG_DEBUG("Task timed out in queue <%s,%s>",
+			      task->queue_id->source, task->queue_id->sink);
+
+		queue = g_hash_table_lookup(processor->task_queues,
+					    task->queue_id);
+		queue->task_cancel_cb(task, queue->user_data);
+	}
+}
+
+static gboolean prv_timeout_tick_cb(gpointer user_data)
+{
+	rsu_task_processor_t *processor = user_data;
+	gint64 now = g_get_monotonic_time() / G_USEC_PER_SEC;
+	guint slots = 0;
+
+	/* Once a whole turn has been scanned, every slot has been checked */
+
+	while (processor->timeout_tick < now &&
+	       slots++ < RSU_TASK_WHEEL_SLOTS) {
+		processor->timeout_tick++;
+		prv_timeout_expire_slot(
+			processor,
+			prv_timeout_slot(processor, processor->timeout_tick),
+			now);
+	}
+
+	processor->timeout_tick = now;
+
+	if (processor->timeout_armed)
+		return TRUE;
+
+	processor->timeout_id = 0;
+
+	return FALSE;
+}
+
+static void prv_timeout_arm(rsu_task_processor_t *processor,
+			    rsu_task_atom_t *task)
 {
-	rsu_task_queue_t *task_queue = user_data;
+	guint timeout;
+	gint64 now;
+
+	task->deadline = 0;
+	task->timed_out = FALSE;
+
+	if (!processor->task_timeout)
+		return;
 
-	task_queue->task_delete_cb(data, task_queue->user_data);
+	/* The timeout of a task only ever extends the default one */
+
+	timeout = MAX(task->timeout, processor->task_timeout);
+	now = g_get_monotonic_time();
+
+	if (!processor->timeout_armed++) {
+		processor->timeout_tick = now / G_USEC_PER_SEC;
+
+		if (!processor->timeout_id)
+			processor->timeout_id =
+				g_timeout_add_seconds(1, prv_timeout_tick_cb,
+						      processor);
+	}
+
+	task->deadline = now + (gint64)timeout * G_USEC_PER_SEC;
+	task->link.data = task;
+	task->link.prev = NULL;
+	task->link.next = NULL;
+	g_queue_push_tail_link(
+		prv_timeout_slot(processor, prv_timeout_second(task->deadline)),
+		&task->link);
 }
 
 static gboolean prv_task_queue_finally_cb(gpointer data)
@@ -106,34 +602,90 @@ static gboolean prv_task_queue_finally_cb(gpointer data)
 static void prv_task_queue_free_cb(gpointer data)
 {
 	rsu_task_queue_t *task_queue = data;
+	rsu_task_atom_t *task;
 
 	RSU_LOG_DEBUG("Enter");
 
-	g_ptr_array_foreach(task_queue->tasks, prv_task_free_cb, task_queue);
-	g_ptr_array_unref(task_queue->tasks);
+	while ((task = prv_task_queue_pop(task_queue)))
+		task_queue->task_delete_cb(task, task_queue->user_data);
+
+	g_ptr_array_unref(task_queue->running);
+
+	if (task_queue->sink) {
+		if (task_queue->waiting)
+			g_queue_remove(&task_queue->sink->waiting_queues,
+				       task_queue);
+		prv_task_sink_unref(task_queue->sink);
+	}
+
+	prv_call_remove(task_queue->processor, &task_queue->process_call);
 
 	if (task_queue->task_queue_finally_cb)
-		g_idle_add(prv_task_queue_finally_cb, task_queue);
+		rsu_task_processor_defer(task_queue->processor,
+					 prv_task_queue_finally_cb,
+					 task_queue);
 	else
 		g_free(task_queue);
 
 	RSU_LOG_DEBUG("Exit");
 }
 
+static gboolean prv_task_queue_process_task(gpointer user_data);
+
 rsu_task_processor_t *rsu_task_processor_new(GSourceFunc on_quit_cb)
 {
 	rsu_task_processor_t *processor;
+	guint i;
 
 	RSU_LOG_DEBUG("Enter");
 
 	processor = g_malloc(sizeof(*processor));
 
+	memset(processor->wait_stats, 0, sizeof(processor->wait_stats));
+	memset(processor->timeouts, 0, sizeof(processor->timeouts));
+	processor->stats = rsu_stats_new();
+	processor->refused_tasks = 0;
+
+	for (i = 0; i < RSU_TASK_WHEEL_SLOTS; ++i)
+		g_queue_init(&processor->timeout_wheel[i]);
+	processor->timeout_tick = 0;
+	processor->timeout_armed = 0;
+	processor->timeout_id = 0;
+	processor->task_timeout = 0;
+
+	g_queue_init(&processor->calls);
+	processor->dispatch_budget = 0;
+	processor->dispatcher = g_source_new(&g_dispatcher_funcs,
+					     sizeof(rsu_task_dispatcher_t));
+	((rsu_task_dispatcher_t *)processor->dispatcher)->processor = processor;
+	g_source_set_priority(processor->dispatcher, G_PRIORITY_DEFAULT_IDLE);
+	(void) g_source_attach(processor->dispatcher, NULL);
+
 	processor->task_queues = g_hash_table_new_full(
 						prv_task_queue_key_hash_cb,
 						prv_task_queue_key_equal_cb,
 						prv_task_queue_key_free_cb,
 						prv_task_queue_free_cb);
+	processor->task_sinks = g_hash_table_new_full(g_str_hash, g_str_equal,
+						      g_free,
+						      prv_task_sink_free_cb);
+	processor->source_index = g_hash_table_new_full(
+						g_str_hash, g_str_equal,
+						g_free,
+						prv_task_queue_index_free_cb);
+	processor->sink_index = g_hash_table_new_full(
+						g_str_hash, g_str_equal,
+						g_free,
+						prv_task_queue_index_free_cb);
+	processor->source_weights = g_hash_table_new_full(g_str_hash,
+							  g_str_equal,
+							  g_free, NULL);
 	processor->running_tasks = 0;
+	processor->queued_tasks = 0;
+	processor->max_queued = 0;
+	processor->max_queued_per_source = 0;
+	processor->max_tasks_per_sink = 0;
+	processor->pipeline_depth = 1;
 	processor->quitting = FALSE;
 	processor->on_quit_cb = on_quit_cb;
 
@@ -144,9 +696,30 @@ rsu_task_processor_t *rsu_task_processor_new(GSourceFunc on_quit_cb)
 
 void rsu_task_processor_free(rsu_task_processor_t *processor)
 {
+	rsu_task_call_t *call;
+
 	RSU_LOG_DEBUG("Enter");
 
 	g_hash_table_unref(processor->task_queues);
+
+	/* Only allocated calls can be left once the queues are gone */
+
+	while (!g_queue_is_empty(&processor->calls)) {
+		call = g_queue_pop_head_link(&processor->calls)->data;
+		g_slice_free(rsu_task_call_t, call);
+	}
+
+	g_source_destroy(processor->dispatcher);
+	g_source_unref(processor->dispatcher);
+
+	if (processor->timeout_id)
+		(void) g_source_remove(processor->timeout_id);
+
+	g_hash_table_unref(processor->task_sinks);
+	g_hash_table_unref(processor->source_index);
+	g_hash_table_unref(processor->sink_index);
+	g_hash_table_unref(processor->source_weights);
+	rsu_stats_free(processor->stats);
 	g_free(processor);
 
 	RSU_LOG_DEBUG("Exit");
@@ -163,6 +736,7 @@ const rsu_task_queue_key_t *rsu_task_processor_add_queue(
 {
 	rsu_task_queue_t *queue;
 	rsu_task_queue_key_t *key;
+	guint i;
 
 	RSU_LOG_DEBUG("Enter - queue <%s,%s>", source, sink);
 
@@ -175,41 +749,170 @@ const rsu_task_queue_key_t *rsu_task_processor_add_queue(
 	queue->task_process_cb = task_process_cb;
 	queue->task_cancel_cb = task_cancel_cb;
 	queue->task_delete_cb = task_delete_cb;
-	queue->tasks = g_ptr_array_new();
+	for (i = 0; i < RSU_TASK_PRIORITY_COUNT; ++i)
+		g_queue_init(&queue->tasks[i]);
+	queue->running = g_ptr_array_new();
 	queue->flags = flags;
+	queue->id = key;
+	queue->processor = processor;
+	queue->process_call.func = prv_task_queue_process_task;
+	queue->process_call.data = key;
+	queue->weight = GPOINTER_TO_UINT(
+			g_hash_table_lookup(processor->source_weights, source));
+	if (!queue->weight)
+		queue->weight = 1;
+
+	if (flags & RSU_TASK_QUEUE_FLAG_LIMIT_SINK)
+		queue->sink = prv_task_sink_ref(processor, sink);
 
 	g_hash_table_insert(processor->task_queues, key, queue);
+	prv_task_queue_index_add(processor->source_index, source, key);
+	prv_task_queue_index_add(processor->sink_index, sink, key);
 
 	RSU_LOG_DEBUG("Exit");
 
 	return key;
 }
 
-static void prv_task_cancel_and_free_cb(gpointer data, gpointer user_data)
+static gint prv_task_queue_compare_finish(gconstpointer a, gconstpointer b,
+					  gpointer user_data)
 {
-	rsu_task_queue_t *task_queue = user_data;
+	const rsu_task_queue_t *queue_a = a;
+	const rsu_task_queue_t *queue_b = b;
 
-	task_queue->task_cancel_cb(data, task_queue->user_data);
-	task_queue->task_delete_cb(data, task_queue->user_data);
+	return queue_a->finish_tag <= queue_b->finish_tag ? -1 : 1;
 }
 
-static void prv_task_queue_cancel(const rsu_task_queue_key_t *queue_id,
-				  rsu_task_queue_t *task_queue)
+static void prv_task_queue_schedule(rsu_task_queue_t *queue)
+{
+	rsu_task_sink_t *sink = queue->sink;
+	guint max_tasks;
+
+	if (sink) {
+		max_tasks = sink->processor->max_tasks_per_sink;
+
+		if (max_tasks && sink->running_tasks >= max_tasks) {
+			RSU_LOG_DEBUG("Queue <%s,%s> waiting for sink",
+				      queue->id->source, queue->id->sink);
+
+			queue->finish_tag = MAX(queue->finish_tag,
+						sink->virtual_time);
+			queue->finish_tag += RSU_TASK_WEIGHT_SCALE /
+				queue->weight;
+			queue->waiting = TRUE;
+			g_queue_insert_sorted(&sink->waiting_queues, queue,
+					      prv_task_queue_compare_finish,
+					      NULL);
+			return;
+		}
+
+		sink->running_tasks++;
+	}
+
+	prv_call_push(queue->processor, &queue->process_call);
+}
+
+/* Read only tasks can be pipelined: up to pipeline_depth of them may run
+ * at the same time.  Any other task is a barrier and runs on its own. */
+
+static gboolean prv_task_queue_can_start(rsu_task_queue_t *queue)
 {
+	rsu_task_atom_t *next;
+	rsu_task_atom_t *running;
+
+	if (queue->running->len == 0)
+		return TRUE;
+
+	if (queue->running->len >= queue->id->processor->pipeline_depth)
+		return FALSE;
+
+	next = prv_task_queue_peek(queue);
+	running = g_ptr_array_index(queue->running, 0);
+
+	return next->read_only && running->read_only;
+}
+
+static void prv_task_queue_try_schedule(rsu_task_queue_t *queue)
+{
+	if (queue->process_call.pending || queue->waiting ||
+	    !queue->task_count)
+		return;
+
+	if (prv_task_queue_can_start(queue))
+		prv_task_queue_schedule(queue);
+}
+
+static void prv_task_queue_release_sink(rsu_task_queue_t *queue)
+{
+	rsu_task_sink_t *sink = queue->sink;
+	rsu_task_queue_t *next;
+
+	if (!sink)
+		return;
+
+	sink->running_tasks--;
+
+	next = g_queue_pop_head(&sink->waiting_queues);
+	if (next) {
+		next->waiting = FALSE;
+		sink->virtual_time = next->finish_tag;
+		prv_task_queue_schedule(next);
+	}
+}
+
+static void prv_task_queue_cancel_pending(rsu_task_queue_t *task_queue)
+{
+	rsu_task_atom_t *task;
+
 	task_queue->cancelled = TRUE;
 
-	g_ptr_array_foreach(task_queue->tasks, prv_task_cancel_and_free_cb,
-			    task_queue);
-	g_ptr_array_set_size(task_queue->tasks, 0);
+	while ((task = prv_task_queue_pop(task_queue))) {
+		task_queue->task_cancel_cb(task, task_queue->user_data);
+		task_queue->task_delete_cb(task, task_queue->user_data);
+	}
+
+	if (task_queue->process_call.pending) {
+		prv_call_remove(task_queue->processor,
+				&task_queue->process_call);
+		prv_task_queue_release_sink(task_queue);
+	}
 
-	if (task_queue->idle_id) {
-		(void) g_source_remove(task_queue->idle_id);
-		task_queue->idle_id = 0;
+	if (task_queue->waiting) {
+		g_queue_remove(&task_queue->sink->waiting_queues, task_queue);
+		task_queue->waiting = FALSE;
 	}
+}
+
+static void prv_task_queue_cancel_running(rsu_task_queue_t *task_queue)
+{
+	rsu_task_cancel_cb_t task_cancel_cb;
+	gpointer user_data;
+	gpointer *running;
+	guint count;
+	guint i;
+
+	/* A cancel callback may complete its task synchronously, which can
+	   free the queue once the last running task is gone. */
+
+	task_cancel_cb = task_queue->task_cancel_cb;
+	user_data = task_queue->user_data;
+	count = task_queue->running->len;
+	running = g_memdup(task_queue->running->pdata,
+			   count * sizeof(*running));
+
+	for (i = 0; i < count; ++i)
+		task_cancel_cb(running[i], user_data);
+
+	g_free(running);
+}
 
-	if (task_queue->current_task) {
-		task_queue->task_cancel_cb(task_queue->current_task,
-					   task_queue->user_data);
+static void prv_task_queue_cancel(const rsu_task_queue_key_t *queue_id,
+				  rsu_task_queue_t *task_queue)
+{
+	prv_task_queue_cancel_pending(task_queue);
+
+	if (task_queue->running->len > 0) {
+		prv_task_queue_cancel_running(task_queue);
 	} else if (task_queue->flags & RSU_TASK_QUEUE_FLAG_AUTO_REMOVE) {
 		RSU_LOG_DEBUG("Removing queue <%s,%s>",
 			      queue_id->source, queue_id->sink);
@@ -245,11 +948,217 @@ void rsu_task_processor_set_quitting(rsu_task_processor_t *processor)
 	if (processor->running_tasks > 0)
 		prv_cancel_all_queues(processor);
 	else
-		g_idle_add(processor->on_quit_cb, NULL);
+		rsu_task_processor_defer(processor, processor->on_quit_cb,
+					 NULL);
 
 	RSU_LOG_DEBUG("Exit");
 }
 
+void rsu_task_processor_defer(rsu_task_processor_t *processor,
+			      GSourceFunc func, gpointer data)
+{
+	rsu_task_call_t *call;
+
+	call = g_slice_new(rsu_task_call_t);
+	call->func = func;
+	call->data = data;
+	call->allocated = TRUE;
+
+	prv_call_push(processor, call);
+}
+
+void rsu_task_processor_set_dispatch_budget(rsu_task_processor_t *processor,
+					    guint budget)
+{
+	RSU_LOG_DEBUG("Dispatch budget: %u", budget);
+
+	processor->dispatch_budget = budget;
+}
+
+void rsu_task_processor_get_wait_stats(const rsu_task_processor_t *processor,
+				       rsu_task_priority_t priority,
+				       rsu_task_wait_stats_t *stats)
+{
+	*stats = processor->wait_stats[priority];
+}
+
+/* Starts the tasks that a higher max_tasks_per_sink or pipeline_depth,
+ * set while the processor runs, now allows to run */
+
+static void prv_task_processor_reschedule(rsu_task_processor_t *processor)
+{
+	guint max_tasks = processor->max_tasks_per_sink;
+	GHashTableIter iter;
+	gpointer value;
+	rsu_task_sink_t *sink;
+	rsu_task_queue_t *next;
+
+	g_hash_table_iter_init(&iter, processor->task_sinks);
+
+	while (g_hash_table_iter_next(&iter, NULL, &value)) {
+		sink = value;
+
+		while (!max_tasks || sink->running_tasks < max_tasks) {
+			next = g_queue_pop_head(&sink->waiting_queues);
+			if (!next)
+				break;
+
+			next->waiting = FALSE;
+			sink->virtual_time = next->finish_tag;
+			prv_task_queue_schedule(next);
+		}
+	}
+
+	g_hash_table_iter_init(&iter, processor->task_queues);
+
+	while (g_hash_table_iter_next(&iter, NULL, &value))
+		prv_task_queue_try_schedule(value);
+}
+
+void rsu_task_processor_set_max_tasks_per_sink(rsu_task_processor_t *processor,
+					       guint max_tasks)
+{
+	RSU_LOG_DEBUG("Max tasks per sink: %u", max_tasks);
+
+	processor->max_tasks_per_sink = max_tasks;
+	prv_task_processor_reschedule(processor);
+}
+
+void rsu_task_processor_set_pipeline_depth(rsu_task_processor_t *processor,
+					   guint depth)
+{
+	RSU_LOG_DEBUG("Pipeline depth: %u", depth);
+
+	processor->pipeline_depth = MAX(depth, 1);
+	prv_task_processor_reschedule(processor);
+}
+
+void rsu_task_processor_set_task_timeout(rsu_task_processor_t *processor,
+					 guint timeout)
+{
+	RSU_LOG_DEBUG("Task timeout: %u", timeout);
+
+	processor->task_timeout = timeout;
+}
+
+guint64 rsu_task_processor_get_timeout_count(
+					const rsu_task_processor_t *processor,
+					rsu_task_priority_t priority)
+{
+	return processor->timeouts[priority];
+}
+
+void rsu_task_processor_set_source_weight(rsu_task_processor_t *processor,
+					  const gchar *source, guint weight)
+{
+	GPtrArray *keys;
+	rsu_task_queue_t *queue;
+	guint i;
+
+	RSU_LOG_DEBUG("Source <%s> weight: %u", source, weight);
+
+	weight = MAX(weight, 1);
+	g_hash_table_insert(processor->source_weights, g_strdup(source),
+			    GUINT_TO_POINTER(weight));
+
+	keys = g_hash_table_lookup(processor->source_index, source);
+
+	for (i = 0; keys && i < keys->len; ++i) {
+		queue = g_hash_table_lookup(processor->task_queues,
+					    g_ptr_array_index(keys, i));
+		queue->weight = weight;
+	}
+}
+
+void rsu_task_processor_set_max_queued(rsu_task_processor_t *processor,
+				       guint max_queued,
+				       guint max_queued_per_source)
+{
+	RSU_LOG_DEBUG("Max queued tasks: %u, per source: %u", max_queued,
+		      max_queued_per_source);
+
+	processor->max_queued = max_queued;
+	processor->max_queued_per_source = max_queued_per_source;
+}
+
+guint rsu_task_processor_get_queued(const rsu_task_processor_t *processor)
+{
+	return processor->queued_tasks;
+}
+
+guint rsu_task_processor_get_source_queued(
+					const rsu_task_processor_t *processor,
+					const gchar *source)
+{
+	GPtrArray *keys;
+	rsu_task_queue_t *queue;
+	guint queued = 0;
+	guint i;
+
+	keys = g_hash_table_lookup(processor->source_index, source);
+
+	for (i = 0; keys && i < keys->len; ++i) {
+		queue = g_hash_table_lookup(processor->task_queues,
+					    g_ptr_array_index(keys, i));
+		if (queue->flags & RSU_TASK_QUEUE_FLAG_BOUNDED)
+			queued += queue->task_count;
+	}
+
+	return queued;
+}
+
+static void prv_sink_gauge_cb(const gchar *sink, GVariantBuilder *vb,
+			      gpointer user_data)
+{
+	rsu_task_processor_t *processor = user_data;
+	GPtrArray *keys;
+	rsu_task_queue_t *queue;
+	guint queued = 0;
+	guint running = 0;
+	guint i;
+
+	keys = g_hash_table_lookup(processor->sink_index, sink);
+
+	for (i = 0; keys && i < keys->len; ++i) {
+		queue = g_hash_table_lookup(processor->task_queues,
+					    g_ptr_array_index(keys, i));
+		queued += queue->task_count;
+		running += queue->running->len;
+	}
+
+	g_variant_builder_add(vb, "{sv}", "Queued",
+			      g_variant_new_uint32(queued));
+	g_variant_builder_add(vb, "{sv}", "Running",
+			      g_variant_new_uint32(running));
+}
+
+void rsu_task_processor_add_statistics(rsu_task_processor_t *processor,
+				       GVariantBuilder *vb)
+{
+	guint64 timeouts = 0;
+	guint i;
+
+	for (i = 0; i < RSU_TASK_PRIORITY_COUNT; ++i)
+		timeouts += processor->timeouts[i];
+
+	g_variant_builder_add(vb, "{sv}", "Queued",
+			      g_variant_new_uint32(processor->queued_tasks));
+	g_variant_builder_add(vb, "{sv}", "Running",
+			      g_variant_new_uint32(processor->running_tasks));
+	g_variant_builder_add(vb, "{sv}", "Refused",
+			      g_variant_new_uint64(processor->refused_tasks));
+	g_variant_builder_add(vb, "{sv}", "TimedOut",
+			      g_variant_new_uint64(timeouts));
+	g_variant_builder_add(vb, "{sv}", "Dispatch",
+			      rsu_stats_dispatch_to_variant(processor->stats));
+	g_variant_builder_add(vb, "{sv}", "Tasks",
+			      rsu_stats_tasks_to_variant(processor->stats));
+	g_variant_builder_add(vb, "{sv}", "Devices",
+			      rsu_stats_sinks_to_variant(processor->stats,
+							 prv_sink_gauge_cb,
+							 processor));
+}
+
 void rsu_task_processor_cancel_queue(const rsu_task_queue_key_t *queue_id)
 {
 	rsu_task_queue_t *queue;
@@ -263,65 +1172,69 @@ void rsu_task_processor_cancel_queue(const rsu_task_queue_key_t *queue_id)
 	RSU_LOG_DEBUG("Exit");
 }
 
-static gboolean prv_free_queue_for_source(gpointer key, gpointer value,
-				      gpointer user_data)
+static void prv_task_queue_remove(const rsu_task_queue_key_t *queue_id)
 {
-	rsu_task_queue_key_t *queue_key = key;
-	rsu_task_queue_t *queue = value;
-	const gchar *source = user_data;
-	gboolean ret_val = FALSE;
+	rsu_task_queue_t *queue;
 
-	if (!strcmp(source, queue_key->source) && !queue->defer_remove) {
-		queue->defer_remove = (queue->current_task != NULL);
-		prv_task_queue_cancel(queue_key, queue);
-		if (!queue->defer_remove) {
-			RSU_LOG_DEBUG("Removing queue <%s,%s>",
-				      queue_key->source, queue_key->sink);
-			ret_val = TRUE;
-			goto end;
-		}
+	queue = g_hash_table_lookup(queue_id->processor->task_queues,
+				    queue_id);
+
+	if (queue->defer_remove)
+		goto exit;
+
+	prv_task_queue_cancel_pending(queue);
+
+	if (queue->running->len > 0) {
+		queue->defer_remove = TRUE;
+		prv_task_queue_cancel_running(queue);
+	} else {
+		RSU_LOG_DEBUG("Removing queue <%s,%s>",
+			      queue_id->source, queue_id->sink);
+		g_hash_table_remove(queue_id->processor->task_queues, queue_id);
 	}
 
-end:
+exit:
 
-	return ret_val;
+	return;
 }
 
-void rsu_task_processor_remove_queues_for_source(
-						rsu_task_processor_t *processor,
-						const gchar *source)
+static void prv_remove_indexed_queues(GHashTable *index, const gchar *name)
 {
-	RSU_LOG_DEBUG("Enter - Source <%s>", source);
+	GPtrArray *keys;
+	gpointer *queue_ids;
+	guint count;
+	guint i;
 
-	g_hash_table_foreach_remove(processor->task_queues,
-				    prv_free_queue_for_source,
-				    (gpointer)source);
+	keys = g_hash_table_lookup(index, name);
 
-	RSU_LOG_DEBUG("Exit");
+	if (!keys)
+		goto exit;
+
+	/* Removing a queue updates the index, so work on a copy */
+
+	count = keys->len;
+	queue_ids = g_memdup(keys->pdata, count * sizeof(*queue_ids));
+
+	for (i = 0; i < count; ++i)
+		prv_task_queue_remove(queue_ids[i]);
+
+	g_free(queue_ids);
+
+exit:
+
+	return;
 }
 
-static gboolean prv_free_queue_for_sink(gpointer key, gpointer value,
-				    gpointer user_data)
+void rsu_task_processor_remove_queues_for_source(
+						rsu_task_processor_t *processor,
+						const gchar *source)
 {
-	rsu_task_queue_key_t *queue_key = key;
-	rsu_task_queue_t *queue = value;
-	const gchar *sink = user_data;
-	gboolean ret_val = FALSE;
-
-	if (!strcmp(sink, queue_key->sink) && !queue->defer_remove) {
-		queue->defer_remove = (queue->current_task != NULL);
-		prv_task_queue_cancel(queue_key, queue);
-		if (!queue->defer_remove) {
-			RSU_LOG_DEBUG("Removing queue <%s,%s>",
-				      queue_key->source, queue_key->sink);
-			ret_val = TRUE;
-			goto end;
-		}
-	}
+	RSU_LOG_DEBUG("Enter - Source <%s>", source);
 
-end:
+	prv_remove_indexed_queues(processor->source_index, source);
+	(void) g_hash_table_remove(processor->source_weights, source);
 
-	return ret_val;
+	RSU_LOG_DEBUG("Exit");
 }
 
 void rsu_task_processor_remove_queues_for_sink(rsu_task_processor_t *processor,
@@ -329,9 +1242,8 @@ void rsu_task_processor_remove_queues_for_sink(rsu_task_processor_t *processor,
 {
 	RSU_LOG_DEBUG("Enter - Sink <%s>", sink);
 
-	g_hash_table_foreach_remove(processor->task_queues,
-				    prv_free_queue_for_sink,
-				    (gpointer)sink);
+	prv_remove_indexed_queues(processor->sink_index, sink);
+	rsu_stats_remove_sink(processor->stats, sink);
 
 	RSU_LOG_DEBUG("Exit");
 }
@@ -360,6 +1272,7 @@ static gboolean prv_task_queue_process_task(gpointer user_data)
 {
 	rsu_task_queue_key_t *queue_id = user_data;
 	rsu_task_queue_t *queue;
+	rsu_task_atom_t *task;
 
 	RSU_LOG_DEBUG("Enter - Start task processing for queue <%s,%s>",
 		      queue_id->source, queue_id->sink);
@@ -368,11 +1281,18 @@ static gboolean prv_task_queue_process_task(gpointer user_data)
 				    queue_id);
 
 	queue->cancelled = FALSE;
-	queue->idle_id = 0;
-	queue->current_task = g_ptr_array_index(queue->tasks, 0);
-	g_ptr_array_remove_index(queue->tasks, 0);
+	task = prv_task_queue_pop(queue);
+	task->start_time = g_get_monotonic_time();
+	prv_task_wait_stats_update(queue_id->processor, task);
+	g_ptr_array_add(queue->running, task);
 	queue_id->processor->running_tasks++;
-	queue->task_process_cb(queue->current_task, queue->user_data);
+
+	/* The queue must not be accessed once the task has been processed,
+	   as it may have completed synchronously and removed the queue. */
+
+	prv_task_queue_try_schedule(queue);
+	prv_timeout_arm(queue_id->processor, task);
+	queue->task_process_cb(task, queue->user_data);
 
 	RSU_LOG_DEBUG("Exit");
 
@@ -389,21 +1309,53 @@ void rsu_task_queue_start(const rsu_task_queue_key_t *queue_id)
 	queue = g_hash_table_lookup(queue_id->processor->task_queues,
 				    queue_id);
 
-	if (queue->defer_remove)
-		goto exit;
-
-	if (!queue->current_task && !queue->idle_id)
-		queue->idle_id = g_idle_add(prv_task_queue_process_task,
-					    (gpointer)queue_id);
+	if (!queue->defer_remove)
+		prv_task_queue_try_schedule(queue);
 
-exit:
 	RSU_LOG_DEBUG("Exit");
 }
 
-void rsu_task_queue_add_task(const rsu_task_queue_key_t *queue_id,
-			     rsu_task_atom_t *task)
+/* Tasks are only refused by RSU_TASK_QUEUE_FLAG_BOUNDED queues, when
+ * either the processor wide or the per source limit of pending tasks is
+ * reached.  A task superseding a pending one is always accepted, as it
+ * does not grow the queue. */
+
+static gboolean prv_task_queue_admit(rsu_task_queue_t *queue)
+{
+	rsu_task_processor_t *processor = queue->processor;
+	guint queued;
+
+	if (!(queue->flags & RSU_TASK_QUEUE_FLAG_BOUNDED))
+		return TRUE;
+
+	if (processor->max_queued &&
+	    processor->queued_tasks >= processor->max_queued) {
+		RSU_LOG_INFO("Task refused: %u tasks queued",
+			     processor->queued_tasks);
+		processor->refused_tasks++;
+		return FALSE;
+	}
+
+	if (processor->max_queued_per_source) {
+		queued = rsu_task_processor_get_source_queued(
+						processor, queue->id->source);
+
+		if (queued >= processor->max_queued_per_source) {
+			RSU_LOG_INFO("Task refused: %u tasks queued by <%s>",
+				     queued, queue->id->source);
+			processor->refused_tasks++;
+			return FALSE;
+		}
+	}
+
+	return TRUE;
+}
+
+gboolean rsu_task_queue_add_task(const rsu_task_queue_key_t *queue_id,
+				 rsu_task_atom_t *task)
 {
 	rsu_task_queue_t *queue;
+	gboolean added = TRUE;
 
 	RSU_LOG_DEBUG("Enter - Task added to queue <%s,%s>", queue_id->source,
 		      queue_id->sink);
@@ -412,24 +1364,30 @@ void rsu_task_queue_add_task(const rsu_task_queue_key_t *queue_id,
 				    queue_id);
 
 	task->queue_id = queue_id;
-	g_ptr_array_add(queue->tasks, task);
 
-	if (queue->defer_remove)
-		goto exit;
+	if (!prv_task_queue_coalesce(queue, task)) {
+		added = prv_task_queue_admit(queue);
+		if (!added)
+			goto exit;
 
-	if (queue->flags & RSU_TASK_QUEUE_FLAG_AUTO_START) {
-		if (!queue->current_task && !queue->idle_id)
-			queue->idle_id = g_idle_add(prv_task_queue_process_task,
-						    (gpointer)queue_id);
+		prv_task_queue_push(queue, task);
 	}
 
+	if (!queue->defer_remove &&
+	    (queue->flags & RSU_TASK_QUEUE_FLAG_AUTO_START))
+		prv_task_queue_try_schedule(queue);
+
 exit:
+
 	RSU_LOG_DEBUG("Exit");
+
+	return added;
 }
 
-void rsu_task_queue_task_completed(const rsu_task_queue_key_t *queue_id)
+void rsu_task_queue_task_completed(rsu_task_atom_t *task)
 {
 	rsu_task_queue_t *queue;
+	const rsu_task_queue_key_t *queue_id = task->queue_id;
 	rsu_task_processor_t *processor = queue_id->processor;
 
 	RSU_LOG_DEBUG("Enter - Task completed for queue <%s,%s>",
@@ -437,23 +1395,34 @@ void rsu_task_queue_task_completed(const rsu_task_queue_key_t *queue_id)
 
 	queue = g_hash_table_lookup(processor->task_queues, queue_id);
 
-	if (queue->current_task) {
-		queue->task_delete_cb(queue->current_task, queue->user_data);
-		queue->current_task = NULL;
-	}
+	prv_timeout_disarm(processor, task);
+
+	if (task->name)
+		rsu_stats_record_task(processor->stats, queue_id->sink,
+				      task->name,
+				      task->start_time - task->queued_time,
+				      g_get_monotonic_time() -
+				      task->start_time);
+
+	if (g_ptr_array_remove_fast(queue->running, task))
+		queue->task_delete_cb(task, queue->user_data);
 
 	processor->running_tasks--;
+	prv_task_queue_release_sink(queue);
 
 	if (processor->quitting && !processor->running_tasks) {
-		g_idle_add(processor->on_quit_cb, NULL);
+		rsu_task_processor_defer(processor, processor->on_quit_cb,
+					 NULL);
 	} else if (queue->defer_remove) {
-		RSU_LOG_DEBUG("Removing queue <%s,%s>",
-			      queue_id->source, queue_id->sink);
-		g_hash_table_remove(processor->task_queues, queue_id);
-	} else if (queue->tasks->len > 0) {
-		queue->idle_id = g_idle_add(prv_task_queue_process_task,
-					    (gpointer)queue_id);
-	} else if (queue->flags & RSU_TASK_QUEUE_FLAG_AUTO_REMOVE) {
+		if (queue->running->len == 0) {
+			RSU_LOG_DEBUG("Removing queue <%s,%s>",
+				      queue_id->source, queue_id->sink);
+			g_hash_table_remove(processor->task_queues, queue_id);
+		}
+	} else if (queue->task_count > 0) {
+		prv_task_queue_try_schedule(queue);
+	} else if (!queue->running->len &&
+		   (queue->flags & RSU_TASK_QUEUE_FLAG_AUTO_REMOVE)) {
 		RSU_LOG_DEBUG("Removing queue <%s,%s>",
 			      queue_id->source, queue_id->sink);
 		g_hash_table_remove(processor->task_queues, queue_id);
@@ -462,6 +1431,16 @@ void rsu_task_queue_task_completed(const rsu_task_queue_key_t *queue_id)
 	RSU_LOG_DEBUG("Exit");
 }
 
+gboolean rsu_task_queue_is_idle(const rsu_task_queue_key_t *queue_id)
+{
+	rsu_task_queue_t *queue;
+
+	queue = g_hash_table_lookup(queue_id->processor->task_queues,
+				    queue_id);
+
+	return !queue->task_count && !queue->running->len;
+}
+
 void rsu_task_queue_set_finally(const rsu_task_queue_key_t *queue_id,
 				rsu_task_finally_cb_t finally_cb)
 {
@@ -473,6 +1452,17 @@ void rsu_task_queue_set_finally(const rsu_task_queue_key_t *queue_id,
 	queue->task_queue_finally_cb = finally_cb;
 }
 
+void rsu_task_queue_set_coalesce(const rsu_task_queue_key_t *queue_id,
+				 rsu_task_coalesce_cb_t coalesce_cb)
+{
+	rsu_task_queue_t *queue;
+	rsu_task_processor_t *processor = queue_id->processor;
+
+	queue = g_hash_table_lookup(processor->task_queues, queue_id);
+
+	queue->task_coalesce_cb = coalesce_cb;
+}
+
 void rsu_task_queue_set_user_data(const rsu_task_queue_key_t *queue_id,
 				  gpointer user_data)
 {
@@ -32,9 +32,19 @@ enum rsu_task_queue_flag_mask_ {
 	RSU_TASK_QUEUE_FLAG_NONE = 0,
 	RSU_TASK_QUEUE_FLAG_AUTO_START = 1,
 	RSU_TASK_QUEUE_FLAG_AUTO_REMOVE = 1 << 1,
+	RSU_TASK_QUEUE_FLAG_LIMIT_SINK = 1 << 2,
+	RSU_TASK_QUEUE_FLAG_PRIORITY = 1 << 3,
+	RSU_TASK_QUEUE_FLAG_BOUNDED = 1 << 4,
 };
 typedef enum rsu_task_queue_flag_mask_ rsu_task_queue_flag_mask;
 
+typedef struct rsu_task_wait_stats_t_ rsu_task_wait_stats_t;
+struct rsu_task_wait_stats_t_ {
+	guint64 count;
+	guint64 total_wait;
+	guint64 max_wait;
+};
+
 typedef struct rsu_task_processor_t_ rsu_task_processor_t;
 
 typedef void (*rsu_task_process_cb_t)(rsu_task_atom_t *task,
@@ -44,10 +54,40 @@ typedef void (*rsu_task_cancel_cb_t)(rsu_task_atom_t *task,
 typedef void (*rsu_task_delete_cb_t)(rsu_task_atom_t *task,
 				     gpointer user_data);
 typedef void (*rsu_task_finally_cb_t)(gboolean cancelled, gpointer user_data);
+typedef gboolean (*rsu_task_coalesce_cb_t)(rsu_task_atom_t *old_task,
+					   rsu_task_atom_t *new_task,
+					   gpointer user_data);
 
 rsu_task_processor_t *rsu_task_processor_new(GSourceFunc on_quit_cb);
 void rsu_task_processor_free(rsu_task_processor_t *processor);
 void rsu_task_processor_set_quitting(rsu_task_processor_t *processor);
+void rsu_task_processor_defer(rsu_task_processor_t *processor,
+			      GSourceFunc func, gpointer data);
+void rsu_task_processor_set_dispatch_budget(rsu_task_processor_t *processor,
+					    guint budget);
+void rsu_task_processor_get_wait_stats(const rsu_task_processor_t *processor,
+				       rsu_task_priority_t priority,
+				       rsu_task_wait_stats_t *stats);
+void rsu_task_processor_set_max_tasks_per_sink(rsu_task_processor_t *processor,
+					       guint max_tasks);
+void rsu_task_processor_set_pipeline_depth(rsu_task_processor_t *processor,
+					   guint depth);
+void rsu_task_processor_set_task_timeout(rsu_task_processor_t *processor,
+					 guint timeout);
+void rsu_task_processor_set_source_weight(rsu_task_processor_t *processor,
+					  const gchar *source, guint weight);
+void rsu_task_processor_set_max_queued(rsu_task_processor_t *processor,
+				       guint max_queued,
+				       guint max_queued_per_source);
+guint rsu_task_processor_get_queued(const rsu_task_processor_t *processor);
+guint rsu_task_processor_get_source_queued(
+					const rsu_task_processor_t *processor,
+					const gchar *source);
+void rsu_task_processor_add_statistics(rsu_task_processor_t *processor,
+				       GVariantBuilder *vb);
+guint64 rsu_task_processor_get_timeout_count(
+					const rsu_task_processor_t *processor,
+					rsu_task_priority_t priority);
 const rsu_task_queue_key_t *rsu_task_processor_add_queue(
 					rsu_task_processor_t *processor,
 					const gchar *source,
@@ -68,11 +108,14 @@ void rsu_task_processor_remove_queues_for_sink(rsu_task_processor_t *processor,
 					       const gchar *sink);
 
 void rsu_task_queue_start(const rsu_task_queue_key_t *queue_id);
-void rsu_task_queue_add_task(const rsu_task_queue_key_t *queue_id,
-			     rsu_task_atom_t *task);
-void rsu_task_queue_task_completed(const rsu_task_queue_key_t *queue_id);
+gboolean rsu_task_queue_add_task(const rsu_task_queue_key_t *queue_id,
+				 rsu_task_atom_t *task);
+void rsu_task_queue_task_completed(rsu_task_atom_t *task);
+gboolean rsu_task_queue_is_idle(const rsu_task_queue_key_t *queue_id);
 void rsu_task_queue_set_finally(const rsu_task_queue_key_t *queue_id,
 				rsu_task_finally_cb_t finally_cb);
+void rsu_task_queue_set_coalesce(const rsu_task_queue_key_t *queue_id,
+				 rsu_task_coalesce_cb_t coalesce_cb);
 void rsu_task_queue_set_user_data(const rsu_task_queue_key_t *queue_id,
 				  gpointer user_data);
 gpointer rsu_task_queue_get_user_data(const rsu_task_queue_key_t *queue_id);
@@ -21,14 +21,74 @@
  */
 
 
+#include <string.h>
+
 #include "error.h"
 #include "async.h"
+#include "prop-defs.h"
+
+/* Renderers usually fetch the media before answering SetAVTransportURI,
+ * so OpenUri is given longer than the default task timeout. */
+#define RSU_TASK_OPEN_URI_TIMEOUT 60
+
+/* Deleted tasks are kept for reuse, up to RSU_TASK_POOL_SIZE of them, so
+ * that steady traffic does not go through the allocator.  All the tasks
+ * have the size of an async task, so any of them can be reused for any
+ * type of task. */
+#define RSU_TASK_POOL_SIZE 32
+
+static rsu_task_t *g_task_pool[RSU_TASK_POOL_SIZE];
+static guint g_task_pool_count;
+static guint64 g_task_allocated;
+static guint64 g_task_reused;
+
+/* Names of the D-Bus methods run by the tasks, used in statistics */
+static const gchar *const g_task_names[] = {
+	"GetVersion", "GetServers", "Raise", "Quit", "Set", "GetAll", "Get",
+	"Pause", "Play", "PlayPause", "Stop", "Next", "Previous", "OpenUri",
+	"Seek", "SetPosition", "GotoTrack", "HostFile", "RemoveFile"
+};
+
+static rsu_task_t *prv_task_alloc(rsu_task_type_t type)
+{
+	rsu_task_t *task;
+
+	if (g_task_pool_count) {
+		task = g_task_pool[--g_task_pool_count];
+		memset(task, 0, sizeof(rsu_async_task_t));
+		++g_task_reused;
+	} else {
+		task = (rsu_task_t *)g_new0(rsu_async_task_t, 1);
+		++g_task_allocated;
+	}
+
+	task->type = type;
+	task->atom.name = g_task_names[type];
+
+	return task;
+}
+
+static void prv_task_free(rsu_task_t *task)
+{
+	if (g_task_pool_count < RSU_TASK_POOL_SIZE)
+		g_task_pool[g_task_pool_count++] = task;
+	else
+		g_free(task);
+}
+
+void rsu_task_add_statistics(GVariantBuilder *vb)
+{
+	g_variant_builder_add(vb, "{sv}", "TasksAllocated",
+			      g_variant_new_uint64(g_task_allocated));
+	g_variant_builder_add(vb, "{sv}", "TasksReused",
+			      g_variant_new_uint64(g_task_reused));
+}
 
 rsu_task_t *rsu_task_get_version_new(GDBusMethodInvocation *invocation)
 {
-	rsu_task_t *task = g_new0(rsu_task_t, 1);
+	rsu_task_t *task = prv_task_alloc(RSU_TASK_GET_VERSION);
 
-	task->type = RSU_TASK_GET_VERSION;
+	task->atom.read_only = TRUE;
 	task->invocation = invocation;
 	task->result_format = "(@s)";
 	task->result = g_variant_ref_sink(g_variant_new_string(VERSION));
@@ -39,9 +99,9 @@ rsu_task_t *rsu_task_get_version_new(GDBusMethodInvocation *invocation)
 
 rsu_task_t *rsu_task_get_servers_new(GDBusMethodInvocation *invocation)
 {
-	rsu_task_t *task = g_new0(rsu_task_t, 1);
+	rsu_task_t *task = prv_task_alloc(RSU_TASK_GET_SERVERS);
 
-	task->type = RSU_TASK_GET_SERVERS;
+	task->atom.read_only = TRUE;
 	task->invocation = invocation;
 	task->result_format = "(@as)";
 	task->synchronous = TRUE;
@@ -51,9 +111,8 @@ rsu_task_t *rsu_task_get_servers_new(GDBusMethodInvocation *invocation)
 
 rsu_task_t *rsu_task_raise_new(GDBusMethodInvocation *invocation)
 {
-	rsu_task_t *task = g_new0(rsu_task_t, 1);
+	rsu_task_t *task = prv_task_alloc(RSU_TASK_RAISE);
 
-	task->type = RSU_TASK_RAISE;
 	task->invocation = invocation;
 	task->synchronous = TRUE;
 
@@ -62,9 +121,8 @@ rsu_task_t *rsu_task_raise_new(GDBusMethodInvocation *invocation)
 
 rsu_task_t *rsu_task_quit_new(GDBusMethodInvocation *invocation)
 {
-	rsu_task_t *task = g_new0(rsu_task_t, 1);
+	rsu_task_t *task = prv_task_alloc(RSU_TASK_QUIT);
 
-	task->type = RSU_TASK_QUIT;
 	task->invocation = invocation;
 	task->synchronous = TRUE;
 
@@ -105,7 +163,37 @@ static void prv_rsu_task_delete(rsu_task_t *task)
 	if (task->result)
 		g_variant_unref(task->result);
 
-	g_free(task);
+	prv_task_free(task);
+}
+
+static rsu_task_priority_t prv_device_task_priority(rsu_task_type_t type)
+{
+	rsu_task_priority_t priority;
+
+	switch (type) {
+	case RSU_TASK_PLAY:
+	case RSU_TASK_PAUSE:
+	case RSU_TASK_PLAY_PAUSE:
+	case RSU_TASK_STOP:
+	case RSU_TASK_NEXT:
+	case RSU_TASK_PREVIOUS:
+	case RSU_TASK_OPEN_URI:
+	case RSU_TASK_HOST_URI:
+	case RSU_TASK_REMOVE_URI:
+		priority = RSU_TASK_PRIORITY_TRANSPORT;
+		break;
+	case RSU_TASK_SEEK:
+	case RSU_TASK_SET_POSITION:
+	case RSU_TASK_GOTO_TRACK:
+	case RSU_TASK_SET_PROP:
+		priority = RSU_TASK_PRIORITY_CONTROL;
+		break;
+	default:
+		priority = RSU_TASK_PRIORITY_READ;
+		break;
+	}
+
+	return priority;
 }
 
 static rsu_task_t *prv_device_task_new(rsu_task_type_t type,
@@ -113,9 +201,9 @@ static rsu_task_t *prv_device_task_new(rsu_task_type_t type,
 				       const gchar *path,
 				       const gchar *result_format)
 {
-	rsu_task_t *task = (rsu_task_t *)g_new0(rsu_async_task_t, 1);
+	rsu_task_t *task = prv_task_alloc(type);
 
-	task->type = type;
+	task->atom.priority = prv_device_task_priority(type);
 	task->invocation = invocation;
 	task->result_format = result_format;
 
@@ -131,6 +219,7 @@ rsu_task_t *rsu_task_get_prop_new(GDBusMethodInvocation *invocation,
 	rsu_task_t *task;
 
 	task = prv_device_task_new(RSU_TASK_GET_PROP, invocation, path, "(v)");
+	task->atom.read_only = TRUE;
 
 	g_variant_get(parameters, "(ss)", &task->ut.get_prop.interface_name,
 		      &task->ut.get_prop.prop_name);
@@ -148,6 +237,7 @@ rsu_task_t *rsu_task_get_props_new(GDBusMethodInvocation *invocation,
 
 	task = prv_device_task_new(RSU_TASK_GET_ALL_PROPS, invocation, path,
 				   "(@a{sv})");
+	task->atom.read_only = TRUE;
 
 	g_variant_get(parameters, "(s)", &task->ut.get_props.interface_name);
 	g_strstrip(task->ut.get_props.interface_name);
@@ -168,6 +258,16 @@ rsu_task_t *rsu_task_set_prop_new(GDBusMethodInvocation *invocation,
 	g_strstrip(task->ut.set_prop.interface_name);
 	g_strstrip(task->ut.set_prop.prop_name);
 
+	if (!strcmp(task->ut.set_prop.interface_name, RSU_INTERFACE_PLAYER) ||
+	    !strcmp(task->ut.set_prop.interface_name, "")) {
+		if (!strcmp(task->ut.set_prop.prop_name,
+			    RSU_INTERFACE_PROP_VOLUME))
+			task->atom.coalesce_id = RSU_TASK_COALESCE_VOLUME;
+		else if (!strcmp(task->ut.set_prop.prop_name,
+				 RSU_INTERFACE_PROP_RATE))
+			task->atom.coalesce_id = RSU_TASK_COALESCE_RATE;
+	}
+
 	return task;
 }
 
@@ -212,6 +312,7 @@ rsu_task_t *rsu_task_seek_new(GDBusMethodInvocation *invocation,
 {
 	rsu_task_t *task = prv_device_task_new(RSU_TASK_SEEK, invocation,
 					       path, NULL);
+	task->atom.coalesce_id = RSU_TASK_COALESCE_SEEK;
 
 	g_variant_get(parameters, "(x)", &task->ut.seek.position);
 
@@ -225,6 +326,7 @@ rsu_task_t *rsu_task_set_position_new(GDBusMethodInvocation *invocation,
 
 	rsu_task_t *task = prv_device_task_new(RSU_TASK_SET_POSITION,
 					       invocation, path, NULL);
+	task->atom.coalesce_id = RSU_TASK_COALESCE_SET_POSITION;
 
 	g_variant_get(parameters, "(&ox)", &track_id, &task->ut.seek.position);
 
@@ -249,6 +351,7 @@ rsu_task_t *rsu_task_open_uri_new(GDBusMethodInvocation *invocation,
 
 	task = prv_device_task_new(RSU_TASK_OPEN_URI, invocation, path,
 				   NULL);
+	task->atom.timeout = RSU_TASK_OPEN_URI_TIMEOUT;
 
 	g_variant_get(parameters, "(s)", &task->ut.open_uri.uri);
 	g_strstrip(task->ut.open_uri.uri);
@@ -335,8 +438,12 @@ void rsu_task_cancel(rsu_task_t *task)
 		goto finished;
 
 	if (task->invocation) {
-		error = g_error_new(RSU_ERROR, RSU_ERROR_CANCELLED,
-				    "Operation cancelled.");
+		if (task->atom.timed_out)
+			error = g_error_new(RSU_ERROR, RSU_ERROR_TIMED_OUT,
+					    "Operation timed out.");
+		else
+			error = g_error_new(RSU_ERROR, RSU_ERROR_CANCELLED,
+					    "Operation cancelled.");
 		g_dbus_method_invocation_return_gerror(task->invocation, error);
 		task->invocation = NULL;
 		g_error_free(error);
@@ -350,6 +457,20 @@ finished:
 	return;
 }
 
+gboolean rsu_task_coalesce(rsu_task_t *old_task, rsu_task_t *new_task)
+{
+	/* Seek, SetPosition, Volume and Rate all set a target value on the
+	   renderer, so the newest task makes the older one redundant.  The
+	   superseded call completes successfully. */
+
+	if (old_task->atom.coalesce_id != new_task->atom.coalesce_id)
+		return FALSE;
+
+	rsu_task_complete(old_task);
+
+	return TRUE;
+}
+
 void rsu_task_delete(rsu_task_t *task)
 {
 	GError *error;
@@ -51,6 +51,18 @@ enum rsu_task_type_t_ {
 };
 typedef enum rsu_task_type_t_ rsu_task_type_t;
 
+/* Pending tasks with the same, non zero, coalesce id are superseded by
+ * the most recent one when task coalescing is enabled */
+
+enum rsu_task_coalesce_id_t_ {
+	RSU_TASK_COALESCE_NONE,
+	RSU_TASK_COALESCE_SEEK,
+	RSU_TASK_COALESCE_SET_POSITION,
+	RSU_TASK_COALESCE_VOLUME,
+	RSU_TASK_COALESCE_RATE
+};
+typedef enum rsu_task_coalesce_id_t_ rsu_task_coalesce_id_t;
+
 typedef void (*rsu_cancel_task_t)(void *handle);
 
 typedef struct rsu_task_get_props_t_ rsu_task_get_props_t;
@@ -145,5 +157,7 @@ void rsu_task_complete(rsu_task_t *task);
 void rsu_task_fail(rsu_task_t *task, GError *error);
 void rsu_task_delete(rsu_task_t *task);
 void rsu_task_cancel(rsu_task_t *task);
+gboolean rsu_task_coalesce(rsu_task_t *old_task, rsu_task_t *new_task);
+void rsu_task_add_statistics(GVariantBuilder *vb);
 
 #endif
@@ -382,7 +382,7 @@ void rsu_upnp_set_prop(rsu_upnp_t *upnp, rsu_task_t *task,
 					     "Cannot locate a device"
 					     " for the specified "
 					     "object");
-		(void) g_idle_add(rsu_async_task_complete, cb_data);
+		rsu_async_task_defer_complete(cb_data);
 	} else {
 		rsu_device_set_prop(device, task, cb);
 	}
@@ -411,7 +411,7 @@ void rsu_upnp_get_prop(rsu_upnp_t *upnp, rsu_task_t *task,
 					     "Cannot locate a device"
 					     " for the specified "
 					     "object");
-		(void) g_idle_add(rsu_async_task_complete, cb_data);
+		rsu_async_task_defer_complete(cb_data);
 	} else {
 		rsu_device_get_prop(device, task, cb);
 	}
@@ -439,7 +439,7 @@ void rsu_upnp_get_all_props(rsu_upnp_t *upnp, rsu_task_t *task,
 					     "Cannot locate a device"
 					     " for the specified "
 					     "object");
-		(void) g_idle_add(rsu_async_task_complete, cb_data);
+		rsu_async_task_defer_complete(cb_data);
 	} else {
 		rsu_device_get_all_props(device, task, cb);
 	}
@@ -447,6 +447,22 @@ void rsu_upnp_get_all_props(rsu_upnp_t *upnp, rsu_task_t *task,
 	RSU_LOG_DEBUG("Exit");
 }
 
+gboolean rsu_upnp_get_cached_props(rsu_upnp_t *upnp, rsu_task_t *task,
+				   GError **error)
+{
+	rsu_device_t *device;
+
+	device = rsu_device_from_path(task->path, upnp->server_udn_map);
+
+	if (!device) {
+		g_set_error(error, RSU_ERROR, RSU_ERROR_OBJECT_NOT_FOUND,
+			    "Cannot locate a device for the specified object");
+		return FALSE;
+	}
+
+	return rsu_device_get_cached_props(device, task, error);
+}
+
 void rsu_upnp_play(rsu_upnp_t *upnp, rsu_task_t *task,
 		   rsu_upnp_task_complete_t cb)
 {
@@ -464,7 +480,7 @@ void rsu_upnp_play(rsu_upnp_t *upnp, rsu_task_t *task,
 					     "Cannot locate a device"
 					     " for the specified "
 					     "object");
-		(void) g_idle_add(rsu_async_task_complete, cb_data);
+		rsu_async_task_defer_complete(cb_data);
 	} else {
 		rsu_device_play(device, task, cb);
 	}
@@ -489,7 +505,7 @@ void rsu_upnp_pause(rsu_upnp_t *upnp, rsu_task_t *task,
 					     "Cannot locate a device"
 					     " for the specified "
 					     "object");
-		(void) g_idle_add(rsu_async_task_complete, cb_data);
+		rsu_async_task_defer_complete(cb_data);
 	} else {
 		rsu_device_pause(device, task, cb);
 	}
@@ -514,7 +530,7 @@ void rsu_upnp_play_pause(rsu_upnp_t *upnp, rsu_task_t *task,
 					     "Cannot locate a device"
 					     " for the specified "
 					     "object");
-		(void) g_idle_add(rsu_async_task_complete, cb_data);
+		rsu_async_task_defer_complete(cb_data);
 	} else {
 		rsu_device_play_pause(device, task, cb);
 	}
@@ -539,7 +555,7 @@ void rsu_upnp_stop(rsu_upnp_t *upnp, rsu_task_t *task,
 					     "Cannot locate a device"
 					     " for the specified "
 					     "object");
-		(void) g_idle_add(rsu_async_task_complete, cb_data);
+		rsu_async_task_defer_complete(cb_data);
 	} else {
 		rsu_device_stop(device, task, cb);
 	}
@@ -564,7 +580,7 @@ void rsu_upnp_next(rsu_upnp_t *upnp, rsu_task_t *task,
 					     "Cannot locate a device"
 					     " for the specified "
 					     "object");
-		(void) g_idle_add(rsu_async_task_complete, cb_data);
+		rsu_async_task_defer_complete(cb_data);
 	} else {
 		rsu_device_next(device, task, cb);
 	}
@@ -589,7 +605,7 @@ void rsu_upnp_previous(rsu_upnp_t *upnp, rsu_task_t *task,
 					     "Cannot locate a device"
 					     " for the specified "
 					     "object");
-		(void) g_idle_add(rsu_async_task_complete, cb_data);
+		rsu_async_task_defer_complete(cb_data);
 	} else {
 		rsu_device_previous(device, task, cb);
 	}
@@ -614,7 +630,7 @@ void rsu_upnp_open_uri(rsu_upnp_t *upnp, rsu_task_t *task,
 					     "Cannot locate a device"
 					     " for the specified "
 					     "object");
-		(void) g_idle_add(rsu_async_task_complete, cb_data);
+		rsu_async_task_defer_complete(cb_data);
 	} else {
 		rsu_device_open_uri(device, task, cb);
 	}
@@ -639,7 +655,7 @@ void rsu_upnp_seek(rsu_upnp_t *upnp, rsu_task_t *task,
 					     "Cannot locate a device"
 					     " for the specified "
 					     "object");
-		(void) g_idle_add(rsu_async_task_complete, cb_data);
+		rsu_async_task_defer_complete(cb_data);
 	} else {
 		rsu_device_seek(device, task, cb);
 	}
@@ -664,7 +680,7 @@ void rsu_upnp_set_position(rsu_upnp_t *upnp, rsu_task_t *task,
 					     "Cannot locate a device"
 					     " for the specified "
 					     "object");
-		(void) g_idle_add(rsu_async_task_complete, cb_data);
+		rsu_async_task_defer_complete(cb_data);
 	} else {
 		rsu_device_set_position(device, task, cb);
 	}
@@ -689,7 +705,7 @@ void rsu_upnp_goto_track(rsu_upnp_t *upnp, rsu_task_t *task,
 					     "Cannot locate a device"
 					     " for the specified "
 					     "object");
-		(void) g_idle_add(rsu_async_task_complete, cb_data);
+		rsu_async_task_defer_complete(cb_data);
 	} else {
 		rsu_device_goto_track(device, task, cb);
 	}
@@ -714,7 +730,7 @@ void rsu_upnp_host_uri(rsu_upnp_t *upnp, rsu_task_t *task,
 					     "Cannot locate a device"
 					     " for the specified "
 					     "object");
-		(void) g_idle_add(rsu_async_task_complete, cb_data);
+		rsu_async_task_defer_complete(cb_data);
 	} else {
 		rsu_device_host_uri(device, task, upnp->host_service, cb);
 	}
@@ -739,7 +755,7 @@ void rsu_upnp_remove_uri(rsu_upnp_t *upnp, rsu_task_t *task,
 					     "Cannot locate a device"
 					     " for the specified "
 					     "object");
-		(void) g_idle_add(rsu_async_task_complete, cb_data);
+		rsu_async_task_defer_complete(cb_data);
 	} else {
 		rsu_device_remove_uri(device, task, upnp->host_service, cb);
 	}
@@ -747,9 +763,36 @@ void rsu_upnp_remove_uri(rsu_upnp_t *upnp, rsu_task_t *task,
 	RSU_LOG_DEBUG("Exit");
 }
 
+void rsu_upnp_subscribe_position(rsu_upnp_t *upnp, const gchar *path,
+				 const gchar *client_name, guint interval)
+{
+	rsu_device_t *device;
+
+	device = rsu_device_from_path(path, upnp->server_udn_map);
+	if (device)
+		rsu_device_subscribe_position(device, client_name, interval);
+}
+
+void rsu_upnp_unsubscribe_position(rsu_upnp_t *upnp, const gchar *path,
+				   const gchar *client_name)
+{
+	rsu_device_t *device;
+
+	device = rsu_device_from_path(path, upnp->server_udn_map);
+	if (device)
+		rsu_device_unsubscribe_position(device, client_name);
+}
+
 void rsu_upnp_lost_client(rsu_upnp_t *upnp, const gchar *client_name)
 {
+	GHashTableIter iter;
+	gpointer value;
+
 	rsu_host_service_lost_client(upnp->host_service, client_name);
+
+	g_hash_table_iter_init(&iter, upnp->server_udn_map);
+	while (g_hash_table_iter_next(&iter, NULL, &value))
+		rsu_device_unsubscribe_position(value, client_name);
 }
 
 void rsu_upnp_unsubscribe(rsu_upnp_t *upnp)
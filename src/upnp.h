@@ -55,6 +55,8 @@ void rsu_upnp_set_prop(rsu_upnp_t *upnp, rsu_task_t *task,
 		       rsu_upnp_task_complete_t cb);
 void rsu_upnp_get_prop(rsu_upnp_t *upnp, rsu_task_t *task,
 		       rsu_upnp_task_complete_t cb);
+gboolean rsu_upnp_get_cached_props(rsu_upnp_t *upnp, rsu_task_t *task,
+				   GError **error);
 void rsu_upnp_get_all_props(rsu_upnp_t *upnp, rsu_task_t *task,
 			    rsu_upnp_task_complete_t cb);
 void rsu_upnp_play(rsu_upnp_t *upnp, rsu_task_t *task,
@@ -81,6 +83,10 @@ void rsu_upnp_host_uri(rsu_upnp_t *upnp, rsu_task_t *task,
 		       rsu_upnp_task_complete_t cb);
 void rsu_upnp_remove_uri(rsu_upnp_t *upnp, rsu_task_t *task,
 			 rsu_upnp_task_complete_t cb);
+void rsu_upnp_subscribe_position(rsu_upnp_t *upnp, const gchar *path,
+				 const gchar *client_name, guint interval);
+void rsu_upnp_unsubscribe_position(rsu_upnp_t *upnp, const gchar *path,
+				   const gchar *client_name);
 void rsu_upnp_lost_client(rsu_upnp_t *upnp, const gchar *client_name);
 void rsu_upnp_unsubscribe(rsu_upnp_t *upnp);
 #endif
@@ -0,0 +1,117 @@
+# pool-bench
+#
+# Copyright (C) 2013 Intel Corporation. All rights reserved.
+#
+# This program is free software; you can redistribute it and/or modify it
+# under the terms and conditions of the GNU Lesser General Public License,
+# version 2.1, as published by the Free Software Foundation.
+#
+# This program is distributed in the hope it will be useful, but WITHOUT
+# ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+# FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+# for more details.
+#
+# You should have received a copy of the GNU Lesser General Public License
+# along with this program; if not, write to the Free Software Foundation, Inc.,
+# 51 Franklin St - Fifth Floor, Boston, MA 02110-1301 USA.
+#
+
+# Counts the tasks and cancellables allocated per request, as reported
+# by GetStatistics, while one renderer is sent bursts of requests.  The
+# first run sends requests that complete, the second one disconnects
+# from the bus with requests still running, so that they are cancelled.
+# Once the pools are filled, both runs should allocate close to nothing
+# per request.
+#
+# usage: python pool-bench.py [server path]
+
+import sys
+import gobject
+import dbus
+import dbus.mainloop.glib
+
+SERVICE = 'com.intel.renderer-service-upnp'
+MANAGER = '/com/intel/RendererServiceUPnP'
+PLAYER = 'org.mpris.MediaPlayer2.Player'
+BURST = 16
+BURSTS = 200
+COUNTERS = ['TasksAllocated', 'TasksReused',
+            'CancellablesAllocated', 'CancellablesReused']
+
+def get_counters():
+    stats = dbus.Interface(bus.get_object(SERVICE, MANAGER),
+                           'com.intel.RendererServiceUPnP.Statistics')
+    values = stats.GetStatistics()
+    return dict((name, int(values.get(name, 0))) for name in COUNTERS)
+
+def print_counters(title, before, requests):
+    after = get_counters()
+    print title
+    for name in COUNTERS:
+        delta = after[name] - before[name]
+        print "  %-22s %8d  %6.3f per request" % \
+            (name, delta, float(delta) / requests)
+
+class Bursts(object):
+    def __init__(self, props, count):
+        self.props = props
+        self.count = count
+        self.pending = 0
+        self.next_burst()
+
+    def next_burst(self):
+        if self.count == 0:
+            loop.quit()
+            return
+        self.count -= 1
+        self.pending = BURST
+        for i in range(BURST):
+            self.props.Get(PLAYER, 'Position',
+                           reply_handler=self.handle_reply,
+                           error_handler=self.handle_reply)
+
+    def handle_reply(self, *args):
+        self.pending -= 1
+        if self.pending == 0:
+            self.next_burst()
+
+def run_completed(path):
+    props = dbus.Interface(bus.get_object(SERVICE, path),
+                           'org.freedesktop.DBus.Properties')
+    Bursts(props, BURSTS)
+    loop.run()
+
+def run_cancelled(path):
+    for i in range(BURSTS):
+        conn = dbus.bus.BusConnection(dbus.bus.BUS_SESSION)
+        props = dbus.Interface(conn.get_object(SERVICE, path),
+                               'org.freedesktop.DBus.Properties')
+        for j in range(BURST):
+            props.Get(PLAYER, 'Position',
+                      reply_handler=lambda *args: None,
+                      error_handler=lambda *args: None)
+        conn.flush()
+        conn.close()
+
+    # Let the service notice the lost clients and cancel their tasks
+    gobject.timeout_add(2000, loop.quit)
+    loop.run()
+
+if __name__ == '__main__':
+    path = MANAGER + '/server/0'
+    if len(sys.argv) > 1:
+        path = sys.argv[1]
+
+    dbus.mainloop.glib.DBusGMainLoop(set_as_default=True)
+    bus = dbus.SessionBus()
+    loop = gobject.MainLoop()
+
+    requests = BURST * BURSTS
+
+    before = get_counters()
+    run_completed(path)
+    print_counters("Completed requests:", before, requests)
+
+    before = get_counters()
+    run_cancelled(path)
+    print_counters("Cancelled requests:", before, requests)
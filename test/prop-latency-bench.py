@@ -0,0 +1,125 @@
+# prop-latency-bench
+#
+# Copyright (C) 2013 Intel Corporation. All rights reserved.
+#
+# This program is free software; you can redistribute it and/or modify it
+# under the terms and conditions of the GNU Lesser General Public License,
+# version 2.1, as published by the Free Software Foundation.
+#
+# This program is distributed in the hope it will be useful, but WITHOUT
+# ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+# FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+# for more details.
+#
+# You should have received a copy of the GNU Lesser General Public License
+# along with this program; if not, write to the Free Software Foundation, Inc.,
+# 51 Franklin St - Fifth Floor, Boston, MA 02110-1301 USA.
+#
+
+# Times Get and GetAll round trips over D-Bus on one renderer.  Cached
+# properties are answered without going through the task queue, while
+# Position, and GetAll on the Player interface, are still queued and
+# show the latency of the queued path.  Each read is timed once on an
+# idle queue, then again while a backlog of Position reads is queued
+# by the same client.
+#
+# usage: python prop-latency-bench.py [server path]
+
+import sys
+import time
+import gobject
+import dbus
+import dbus.mainloop.glib
+
+ROOT = 'org.mpris.MediaPlayer2'
+PLAYER = 'org.mpris.MediaPlayer2.Player'
+COUNT = 500
+BACKLOG = 200
+
+READS = [
+    ('Get Identity (cached)',
+     lambda h, e: props.Get(ROOT, 'Identity',
+                            reply_handler=h, error_handler=e)),
+    ('Get PlaybackStatus (cached)',
+     lambda h, e: props.Get(PLAYER, 'PlaybackStatus',
+                            reply_handler=h, error_handler=e)),
+    ('GetAll root (cached)',
+     lambda h, e: props.GetAll(ROOT, reply_handler=h, error_handler=e)),
+    ('Get Position (queued)',
+     lambda h, e: props.Get(PLAYER, 'Position',
+                            reply_handler=h, error_handler=e)),
+    ('GetAll Player (queued)',
+     lambda h, e: props.GetAll(PLAYER, reply_handler=h, error_handler=e)),
+]
+
+def percentile(samples, p):
+    return samples[min(len(samples) - 1, int(len(samples) * p))]
+
+class Timing(object):
+    def __init__(self, name, read, backlog):
+        self.name = name
+        self.read = read
+        self.samples = []
+        self.errors = 0
+        self.backlog = backlog
+        self.next_read()
+
+    def queue_backlog(self):
+        for i in range(self.backlog):
+            props.Get(PLAYER, 'Position',
+                      reply_handler=lambda *args: None,
+                      error_handler=lambda *args: None)
+
+    def next_read(self):
+        if len(self.samples) + self.errors == COUNT:
+            self.report()
+            gobject.idle_add(next_timing)
+            return
+        if self.backlog and len(self.samples) % 50 == 0:
+            self.queue_backlog()
+        self.start = time.time()
+        self.read(self.handle_reply, self.handle_error)
+
+    def handle_reply(self, *args):
+        self.samples.append((time.time() - self.start) * 1000000)
+        self.next_read()
+
+    def handle_error(self, err):
+        self.errors += 1
+        self.next_read()
+
+    def report(self):
+        s = sorted(self.samples)
+        if not s:
+            print "%-30s all %d reads failed" % (self.name, self.errors)
+            return
+        print "%-30s p50 %8.0f  p90 %8.0f  max %8.0f us, %d errors" % \
+            (self.name, percentile(s, 0.5), percentile(s, 0.9), s[-1],
+             self.errors)
+
+def next_timing():
+    if TIMINGS:
+        Timing(*TIMINGS.pop(0))
+    else:
+        loop.quit()
+    return False
+
+if __name__ == '__main__':
+    path = '/com/intel/RendererServiceUPnP/server/0'
+    if len(sys.argv) > 1:
+        path = sys.argv[1]
+
+    dbus.mainloop.glib.DBusGMainLoop(set_as_default=True)
+
+    bus = dbus.SessionBus()
+    props = dbus.Interface(bus.get_object('com.intel.renderer-service-upnp',
+                                          path),
+                           'org.freedesktop.DBus.Properties')
+
+    TIMINGS = [(name, read, 0) for (name, read) in READS] + \
+        [(name + ', backlog', read, BACKLOG) for (name, read) in READS]
+
+    gobject.idle_add(next_timing)
+
+    loop = gobject.MainLoop()
+    loop.run()
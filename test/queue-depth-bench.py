@@ -0,0 +1,84 @@
+# queue-depth-bench
+#
+# Copyright (C) 2013 Intel Corporation. All rights reserved.
+#
+# This program is free software; you can redistribute it and/or modify it
+# under the terms and conditions of the GNU Lesser General Public License,
+# version 2.1, as published by the Free Software Foundation.
+#
+# This program is distributed in the hope it will be useful, but WITHOUT
+# ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+# FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+# for more details.
+#
+# You should have received a copy of the GNU Lesser General Public License
+# along with this program; if not, write to the Free Software Foundation, Inc.,
+# 51 Franklin St - Fifth Floor, Boston, MA 02110-1301 USA.
+#
+
+# Queues bursts of growing size on one renderer and prints the average
+# time per request.  Position reads go through the task queue of the
+# client, so the time per request should stay flat as the burst, hence
+# the depth of the queue, grows.  Run it with max-queued-tasks and
+# max-queued-tasks-per-client set to 0, and a renderer that is playing.
+#
+# usage: python queue-depth-bench.py [server path]
+
+import sys
+import time
+import gobject
+import dbus
+import dbus.mainloop.glib
+
+PLAYER = 'org.mpris.MediaPlayer2.Player'
+DEPTHS = [100, 1000, 2000, 5000, 10000]
+
+class Burst(object):
+    def __init__(self, depth):
+        self.depth = depth
+        self.pending = depth
+        self.errors = 0
+        self.start = time.time()
+        for i in range(depth):
+            props.Get(PLAYER, 'Position',
+                      reply_handler=self.handle_reply,
+                      error_handler=self.handle_error)
+
+    def done(self):
+        self.pending -= 1
+        if self.pending == 0:
+            elapsed = time.time() - self.start
+            print "depth %6d: %8.1f us per request, %d errors" % \
+                (self.depth, elapsed * 1000000 / self.depth, self.errors)
+            next_burst()
+
+    def handle_reply(self, position):
+        self.done()
+
+    def handle_error(self, err):
+        self.errors += 1
+        self.done()
+
+def next_burst():
+    if DEPTHS:
+        Burst(DEPTHS.pop(0))
+    else:
+        loop.quit()
+    return False
+
+if __name__ == '__main__':
+    path = '/com/intel/RendererServiceUPnP/server/0'
+    if len(sys.argv) > 1:
+        path = sys.argv[1]
+
+    dbus.mainloop.glib.DBusGMainLoop(set_as_default=True)
+
+    bus = dbus.SessionBus()
+    props = dbus.Interface(bus.get_object('com.intel.renderer-service-upnp',
+                                          path),
+                           'org.freedesktop.DBus.Properties')
+
+    gobject.idle_add(next_burst)
+
+    loop = gobject.MainLoop()
+    loop.run()
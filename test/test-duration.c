@@ -0,0 +1,227 @@
+/*
+ * renderer-service-upnp
+ *
+ * Copyright (C) 2013 Intel Corporation. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU Lesser General Public License,
+ * version 2.1, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St - Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ */
+
+
+
+/* Checks the UPnP duration codec on valid and invalid durations, and
+ * that formatted durations parse back to the same value.  Run with
+ * -m perf to time both directions. */
+
+#include <string.h>
+
+#include "../src/duration.h"
+
+#define TEST_ITERATIONS 1000000
+#define TEST_RANDOM_ROUND_TRIPS 10000
+
+typedef struct test_duration_t_ test_duration_t;
+struct test_duration_t_ {
+	const gchar *duration;
+	gint64 micro_seconds;
+};
+
+static const test_duration_t g_valid[] = {
+	{ "0:00:00", 0 },
+	{ "00:03:25", G_GINT64_CONSTANT(205000000) },
+	{ "0:03:25.000", G_GINT64_CONSTANT(205000000) },
+	{ "1:02:03.5", G_GINT64_CONSTANT(3723500000) },
+	{ "01:02:03.123456", G_GINT64_CONSTANT(3723123456) },
+	{ "01:02:03.1234567", G_GINT64_CONSTANT(3723123456) },
+	{ "0:00:01.0123456789012345678901234567890", 1012345 },
+	{ "0:0:1", 1000000 },
+	{ "100:59:59", G_GINT64_CONSTANT(363599000000) },
+	{ "0:00:00.1/3", 333333 },
+	{ "0:00:01.1/2", 1500000 },
+	{ "0:00:00.999999999999999998/999999999999999999", 999999 },
+	{ "0:00:00.000000000000000001/999999999999999999", 0 },
+	{ "-0:00:01.5", -1500000 },
+	{ "+1:00:00", G_GINT64_CONSTANT(3600000000) },
+	{ " \t0:00:10 \r\n", 10000000 },
+	{ "2562047788:00:54.775807", G_MAXINT64 },
+	{ "-2562047788:00:54.775807", -G_MAXINT64 },
+	{ "000000000000000001:00:00", G_GINT64_CONSTANT(3600000000) }
+};
+
+static const gchar * const g_invalid[] = {
+	"",
+	"NOT_IMPLEMENTED",
+	"0:99:99",
+	"0:60:00",
+	"0:00:60",
+	"0:000:00",
+	"0:00:000",
+	":00:00",
+	"0::00",
+	"0:00",
+	"0:00:00:00",
+	"0:00:00.",
+	"0:00:00.1/",
+	"0:00:00./3",
+	"0:00:00.2/1",
+	"0:00:00.1/1",
+	"0:00:00.0/0",
+	"0:00:00.1/1000000000000000000",
+	"0:00:00.1000000000000000000/2000000000000000000",
+	"0:00:00x",
+	"0:00:00.12a",
+	"0:00:00 1",
+	"--0:00:00",
+	"- 0:00:00",
+	"1e3:00:00",
+	"2562047788:00:54.775808",
+	"2562047789:00:00",
+	"-2562047788:00:54.775808",
+	"1000000000000000000:00:00",
+	"99999999999999999999:00:00"
+};
+
+static const test_duration_t g_formatted[] = {
+	{ "00:00:00", 0 },
+	{ "00:00:00.000001", 1 },
+	{ "00:00:00.999999", 999999 },
+	{ "00:00:01", 1000000 },
+	{ "00:03:25", G_GINT64_CONSTANT(205000000) },
+	{ "01:02:03.5", G_GINT64_CONSTANT(3723500000) },
+	{ "01:02:03.12", G_GINT64_CONSTANT(3723120000) },
+	{ "23:59:59.99999", G_GINT64_CONSTANT(86399999990) },
+	{ "100:00:00", G_GINT64_CONSTANT(360000000000) },
+	{ "-00:00:01.5", -1500000 },
+	{ "2562047788:00:54.775807", G_MAXINT64 },
+	{ "-2562047788:00:54.775807", -G_MAXINT64 },
+	{ "-2562047788:00:54.775808", G_MININT64 }
+};
+
+static void prv_test_valid(void)
+{
+	gint64 micro_seconds;
+	guint i;
+
+	for (i = 0; i < G_N_ELEMENTS(g_valid); ++i) {
+		g_assert(rsu_duration_parse(g_valid[i].duration,
+					    &micro_seconds));
+		g_assert_cmpint(micro_seconds, ==, g_valid[i].micro_seconds);
+	}
+}
+
+static void prv_test_invalid(void)
+{
+	gint64 micro_seconds;
+	guint i;
+
+	for (i = 0; i < G_N_ELEMENTS(g_invalid); ++i) {
+		micro_seconds = 1;
+		g_assert(!rsu_duration_parse(g_invalid[i], &micro_seconds));
+		g_assert_cmpint(micro_seconds, ==, 0);
+	}
+}
+
+static void prv_test_format(void)
+{
+	gchar buffer[RSU_DURATION_SIZE];
+	const test_duration_t *test;
+	guint i;
+
+	for (i = 0; i < G_N_ELEMENTS(g_formatted); ++i) {
+		test = &g_formatted[i];
+		g_assert_cmpstr(rsu_duration_format(test->micro_seconds,
+						    buffer),
+				==, test->duration);
+	}
+}
+
+static void prv_check_round_trip(gint64 micro_seconds)
+{
+	gchar buffer[RSU_DURATION_SIZE];
+	gint64 parsed;
+
+	g_assert(rsu_duration_parse(rsu_duration_format(micro_seconds,
+							buffer),
+				    &parsed));
+	g_assert_cmpint(parsed, ==, micro_seconds);
+}
+
+static void prv_test_round_trip(void)
+{
+	guint64 random;
+	guint i;
+
+	/* G_MININT64 cannot be parsed back, as its opposite does not fit in
+	   a gint64 */
+
+	for (i = 0; i < G_N_ELEMENTS(g_formatted); ++i)
+		if (g_formatted[i].micro_seconds != G_MININT64)
+			prv_check_round_trip(g_formatted[i].micro_seconds);
+
+	for (i = 0; i < TEST_RANDOM_ROUND_TRIPS; ++i) {
+		random = (guint64)(guint32)g_test_rand_int() << 32 |
+			(guint32)g_test_rand_int();
+
+		if ((gint64)random != G_MININT64)
+			prv_check_round_trip((gint64)random);
+
+		/* Durations of actual tracks, up to a day */
+
+		prv_check_round_trip(random % (G_GINT64_CONSTANT(86400) *
+					       G_USEC_PER_SEC));
+	}
+}
+
+static void prv_benchmark(void)
+{
+	gchar buffer[RSU_DURATION_SIZE];
+	gint64 micro_seconds;
+	guint64 sum = 0;
+	gdouble elapsed;
+	guint i;
+
+	g_test_timer_start();
+	for (i = 0; i < TEST_ITERATIONS; ++i) {
+		(void) rsu_duration_parse(g_valid[i % G_N_ELEMENTS(g_valid)].
+					  duration, &micro_seconds);
+		sum += (guint64)micro_seconds;
+	}
+	elapsed = g_test_timer_elapsed();
+
+	g_print("parse:  %6.1f ns per duration (%"G_GUINT64_FORMAT")\n",
+		elapsed * 1000000000 / TEST_ITERATIONS, sum);
+
+	g_test_timer_start();
+	for (i = 0; i < TEST_ITERATIONS; ++i)
+		(void) rsu_duration_format((gint64)i * 1234567, buffer);
+	elapsed = g_test_timer_elapsed();
+
+	g_print("format: %6.1f ns per duration\n",
+		elapsed * 1000000000 / TEST_ITERATIONS);
+}
+
+int main(int argc, char *argv[])
+{
+	g_test_init(&argc, &argv, NULL);
+
+	g_test_add_func("/duration/valid", prv_test_valid);
+	g_test_add_func("/duration/invalid", prv_test_invalid);
+	g_test_add_func("/duration/format", prv_test_format);
+	g_test_add_func("/duration/round-trip", prv_test_round_trip);
+
+	if (g_test_perf())
+		g_test_add_func("/duration/benchmark", prv_benchmark);
+
+	return g_test_run();
+}
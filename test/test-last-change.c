@@ -0,0 +1,313 @@
+/*
+ * renderer-service-upnp
+ *
+ * Copyright (C) 2013 Intel Corporation. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU Lesser General Public License,
+ * version 2.1, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St - Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ */
+
+
+
+/* Runs a corpus of LastChange events, as sent by renderers, through both
+ * the scanner and the generic GUPnP parser, and checks they read the same
+ * values.  Run with -m perf to time both parsers on each event. */
+
+#include <string.h>
+
+#include "../src/last-change.c"
+
+#define TEST_NAME_COUNT 6
+#define TEST_SCAN_ITERATIONS 100000
+#define TEST_GENERIC_ITERATIONS 2000
+
+static const gchar * const g_names[TEST_NAME_COUNT] = {
+	"TransportState",
+	"CurrentTrackURI",
+	"CurrentTrackMetaData",
+	"CurrentTrackDuration",
+	"Volume",
+	"Mute"
+};
+
+/* The scanner gives up on the TEST_FALLBACK events.  The generic parser
+ * reads the first element of a variable, whatever its channel, which is
+ * not the Master channel read by the scanner in the TEST_GENERIC_DIFFERS
+ * events.  It also fails, without reading anything, on the
+ * TEST_NO_INSTANCE events, which do not carry the instance asked for. */
+
+#define TEST_FALLBACK		(1 << 0)
+#define TEST_GENERIC_DIFFERS	(1 << 1)
+#define TEST_NO_INSTANCE	(1 << 2)
+
+typedef struct test_event_t_ test_event_t;
+struct test_event_t_ {
+	const gchar *path;
+	const gchar *event;
+	guint instance_id;
+	guint flags;
+	const gchar *values[TEST_NAME_COUNT];
+};
+
+static const test_event_t g_events[] = {
+	{ "/last-change/av/playing",
+	  "<Event xmlns=\"urn:schemas-upnp-org:metadata-1-0/AVT/\">"
+	  "<InstanceID val=\"0\">"
+	  "<TransportState val=\"PLAYING\"/>"
+	  "<CurrentTrackURI val=\"http://192.168.1.10:8200/MediaItems/22.mp3"
+	  "?profile=MP3&amp;seek=1\"/>"
+	  "<CurrentTrackDuration val=\"0:03:25.000\"/>"
+	  "</InstanceID></Event>",
+	  0, 0,
+	  { "PLAYING",
+	    "http://192.168.1.10:8200/MediaItems/22.mp3?profile=MP3&seek=1",
+	    NULL, "0:03:25.000", NULL, NULL } },
+
+	{ "/last-change/av/meta-data",
+	  "<Event xmlns=\"urn:schemas-upnp-org:metadata-1-0/AVT/\">\n"
+	  "<InstanceID val=\"0\">\n"
+	  "<CurrentTrackMetaData val=\"&lt;DIDL-Lite xmlns=&quot;"
+	  "urn:schemas-upnp-org:metadata-1-0/DIDL-Lite/&quot; xmlns:dc=&quot;"
+	  "http://purl.org/dc/elements/1.1/&quot;&gt;&lt;item id=&quot;22"
+	  "&quot;&gt;&lt;dc:title&gt;Caf&#xE9; &amp;amp; Cr&#232;me "
+	  "&#x4E2D;&apos;s&lt;/dc:title&gt;&lt;/item&gt;"
+	  "&lt;/DIDL-Lite&gt;\"/>\n"
+	  "<TransportState val=\"TRANSITIONING\"/>\n"
+	  "</InstanceID>\n"
+	  "</Event>\n",
+	  0, 0,
+	  { "TRANSITIONING", NULL,
+	    "<DIDL-Lite xmlns=\"urn:schemas-upnp-org:metadata-1-0/DIDL-Lite/\""
+	    " xmlns:dc=\"http://purl.org/dc/elements/1.1/\"><item id=\"22\">"
+	    "<dc:title>Caf\xc3\xa9 &amp; Cr\xc3\xa8me \xe4\xb8\xad's"
+	    "</dc:title></item></DIDL-Lite>",
+	    NULL, NULL, NULL } },
+
+	{ "/last-change/av/declaration",
+	  "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\r\n"
+	  "<Event xmlns=\"urn:schemas-upnp-org:metadata-1-0/AVT/\">\r\n"
+	  "  <InstanceID val=\"0\">\r\n"
+	  "    <TransportState val='PAUSED_PLAYBACK' />\r\n"
+	  "    <CurrentTrackMetaData val=\"NOT_IMPLEMENTED\"/>\r\n"
+	  "  </InstanceID>\r\n"
+	  "</Event>\r\n",
+	  0, 0,
+	  { "PAUSED_PLAYBACK", NULL, "NOT_IMPLEMENTED", NULL, NULL, NULL } },
+
+	{ "/last-change/av/white-space",
+	  "<Event xmlns=\"urn:schemas-upnp-org:metadata-1-0/AVT/\">"
+	  "<InstanceID val=\"0\">"
+	  "<CurrentTrackURI val=\"http://host/a\r\nb\tc\"/>"
+	  "</InstanceID></Event>",
+	  0, 0,
+	  { NULL, "http://host/a b c", NULL, NULL, NULL, NULL } },
+
+	{ "/last-change/av/instances/0",
+	  "<Event xmlns=\"urn:schemas-upnp-org:metadata-1-0/AVT/\">"
+	  "<InstanceID val=\"1\">"
+	  "<TransportState val=\"PLAYING\"/>"
+	  "<CurrentTrackURI val=\"http://host/1.mp3\"/>"
+	  "</InstanceID>"
+	  "<InstanceID val=\"0\">"
+	  "<TransportState val=\"STOPPED\"/>"
+	  "</InstanceID></Event>",
+	  0, 0,
+	  { "STOPPED", NULL, NULL, NULL, NULL, NULL } },
+
+	{ "/last-change/av/instances/1",
+	  "<Event xmlns=\"urn:schemas-upnp-org:metadata-1-0/AVT/\">"
+	  "<InstanceID val=\"1\">"
+	  "<TransportState val=\"PLAYING\"/>"
+	  "<CurrentTrackURI val=\"http://host/1.mp3\"/>"
+	  "</InstanceID>"
+	  "<InstanceID val=\"0\">"
+	  "<TransportState val=\"STOPPED\"/>"
+	  "</InstanceID></Event>",
+	  1, 0,
+	  { "PLAYING", "http://host/1.mp3", NULL, NULL, NULL, NULL } },
+
+	{ "/last-change/av/missing-instance",
+	  "<Event xmlns=\"urn:schemas-upnp-org:metadata-1-0/AVT/\">"
+	  "<InstanceID val=\"1\">"
+	  "<TransportState val=\"PLAYING\"/>"
+	  "</InstanceID></Event>",
+	  0, TEST_NO_INSTANCE,
+	  { NULL, NULL, NULL, NULL, NULL, NULL } },
+
+	{ "/last-change/av/empty",
+	  "<Event xmlns=\"urn:schemas-upnp-org:metadata-1-0/AVT/\"/>",
+	  0, TEST_NO_INSTANCE,
+	  { NULL, NULL, NULL, NULL, NULL, NULL } },
+
+	{ "/last-change/rc/master",
+	  "<Event xmlns=\"urn:schemas-upnp-org:metadata-1-0/RCS/\">"
+	  "<InstanceID val=\"0\">"
+	  "<Volume channel=\"Master\" val=\"40\"/>"
+	  "<Volume channel=\"LF\" val=\"35\"/>"
+	  "<Volume channel=\"RF\" val=\"38\"/>"
+	  "<Mute channel=\"Master\" val=\"0\"/>"
+	  "<PresetNameList val=\"FactoryDefaults,InstallationDefaults\"/>"
+	  "</InstanceID></Event>",
+	  0, 0,
+	  { NULL, NULL, NULL, NULL, "40", "0" } },
+
+	{ "/last-change/rc/master-last",
+	  "<Event xmlns=\"urn:schemas-upnp-org:metadata-1-0/RCS/\">"
+	  "<InstanceID val=\"0\">"
+	  "<Volume channel=\"LF\" val=\"35\"/>"
+	  "<Volume channel=\"Master\" val=\"40\"/>"
+	  "<Mute channel=\"Master\" val=\"1\"/>"
+	  "</InstanceID></Event>",
+	  0, TEST_GENERIC_DIFFERS,
+	  { NULL, NULL, NULL, NULL, "40", "1" } },
+
+	{ "/last-change/rc/no-master",
+	  "<Event xmlns=\"urn:schemas-upnp-org:metadata-1-0/RCS/\">"
+	  "<InstanceID val=\"0\">"
+	  "<Volume channel=\"LF\" val=\"35\"/>"
+	  "<Volume channel=\"RF\" val=\"38\"/>"
+	  "</InstanceID></Event>",
+	  0, TEST_GENERIC_DIFFERS,
+	  { NULL, NULL, NULL, NULL, NULL, NULL } },
+
+	{ "/last-change/fallback/comment",
+	  "<Event xmlns=\"urn:schemas-upnp-org:metadata-1-0/AVT/\">"
+	  "<InstanceID val=\"0\">"
+	  "<!-- Sent by the renderer -->"
+	  "<TransportState val=\"STOPPED\"/>"
+	  "</InstanceID></Event>",
+	  0, TEST_FALLBACK,
+	  { "STOPPED", NULL, NULL, NULL, NULL, NULL } },
+
+	{ "/last-change/fallback/end-tag",
+	  "<Event xmlns=\"urn:schemas-upnp-org:metadata-1-0/AVT/\">"
+	  "<InstanceID val=\"0\">"
+	  "<TransportState val=\"PLAYING\"></TransportState>"
+	  "</InstanceID></Event>",
+	  0, TEST_FALLBACK,
+	  { "PLAYING", NULL, NULL, NULL, NULL, NULL } },
+
+	{ "/last-change/fallback/text",
+	  "<Event xmlns=\"urn:schemas-upnp-org:metadata-1-0/RCS/\">"
+	  "<InstanceID val=\"0\">"
+	  "text<Mute channel=\"Master\" val=\"0\"/>"
+	  "</InstanceID></Event>",
+	  0, TEST_FALLBACK,
+	  { NULL, NULL, NULL, NULL, NULL, "0" } }
+};
+
+static void prv_check_values(const test_event_t *test, gchar **values)
+{
+	guint i;
+
+	for (i = 0; i < TEST_NAME_COUNT; ++i)
+		g_assert_cmpstr(values[i], ==, test->values[i]);
+
+	prv_clear_values(values, TEST_NAME_COUNT);
+}
+
+static void prv_test_event(gconstpointer data)
+{
+	const test_event_t *test = data;
+	gchar *values[TEST_NAME_COUNT];
+	gboolean scanned;
+	gboolean generic;
+
+	memset(values, 0, sizeof(values));
+	scanned = prv_scan(test->event, test->instance_id, g_names, values,
+			   TEST_NAME_COUNT);
+
+	if (test->flags & TEST_FALLBACK) {
+		g_assert(!scanned);
+		prv_clear_values(values, TEST_NAME_COUNT);
+	} else {
+		g_assert(scanned);
+		prv_check_values(test, values);
+	}
+
+	if (!(test->flags & TEST_GENERIC_DIFFERS)) {
+		generic = prv_parse_generic(test->event, test->instance_id,
+					    g_names, values, TEST_NAME_COUNT);
+		g_assert(generic == !(test->flags & TEST_NO_INSTANCE));
+		prv_check_values(test, values);
+	}
+
+	g_assert(rsu_last_change_parse(test->event, test->instance_id,
+				       g_names, values, TEST_NAME_COUNT));
+	prv_check_values(test, values);
+}
+
+static void prv_test_null(void)
+{
+	gchar *values[TEST_NAME_COUNT];
+
+	g_assert(!rsu_last_change_parse(NULL, 0, g_names, values,
+					TEST_NAME_COUNT));
+}
+
+static void prv_benchmark(void)
+{
+	gchar *values[TEST_NAME_COUNT];
+	const test_event_t *test;
+	gdouble scan;
+	gdouble generic;
+	guint i;
+	guint j;
+
+	memset(values, 0, sizeof(values));
+
+	for (i = 0; i < G_N_ELEMENTS(g_events); ++i) {
+		test = &g_events[i];
+
+		g_test_timer_start();
+		for (j = 0; j < TEST_SCAN_ITERATIONS; ++j) {
+			(void) prv_scan(test->event, test->instance_id,
+					g_names, values, TEST_NAME_COUNT);
+			prv_clear_values(values, TEST_NAME_COUNT);
+		}
+		scan = g_test_timer_elapsed() * 1000000 / TEST_SCAN_ITERATIONS;
+
+		g_test_timer_start();
+		for (j = 0; j < TEST_GENERIC_ITERATIONS; ++j) {
+			(void) prv_parse_generic(test->event,
+						 test->instance_id, g_names,
+						 values, TEST_NAME_COUNT);
+			prv_clear_values(values, TEST_NAME_COUNT);
+		}
+		generic = g_test_timer_elapsed() * 1000000 /
+			TEST_GENERIC_ITERATIONS;
+
+		g_print("%-36s scan %8.2f us  generic %8.2f us\n",
+			test->path, scan, generic);
+	}
+}
+
+int main(int argc, char *argv[])
+{
+	guint i;
+
+	g_type_init();
+	g_test_init(&argc, &argv, NULL);
+
+	for (i = 0; i < G_N_ELEMENTS(g_events); ++i)
+		g_test_add_data_func(g_events[i].path, &g_events[i],
+				     prv_test_event);
+
+	g_test_add_func("/last-change/null", prv_test_null);
+
+	if (g_test_perf())
+		g_test_add_func("/last-change/benchmark", prv_benchmark);
+
+	return g_test_run();
+}
@@ -0,0 +1,343 @@
+/*
+ * renderer-service-upnp
+ *
+ * Copyright (C) 2013 Intel Corporation. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU Lesser General Public License,
+ * version 2.1, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St - Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ */
+
+
+
+/* Checks that property names map to their slot, and, run with -m perf,
+ * times the name lookup and the Get and GetAll slot walks of device.c
+ * against the GHashTables the properties used to be kept in. */
+
+#include <string.h>
+
+#include "../src/prop-defs.h"
+#include "../src/props.h"
+
+#define TEST_ITERATIONS 1000000
+#define TEST_GET_ALL_ITERATIONS 100000
+
+typedef struct test_prop_t_ test_prop_t;
+struct test_prop_t_ {
+	const gchar *name;
+	rsu_prop_t prop;
+};
+
+static const test_prop_t g_props[] = {
+	{ RSU_INTERFACE_PROP_CAN_QUIT, RSU_PROP_CAN_QUIT },
+	{ RSU_INTERFACE_PROP_CAN_RAISE, RSU_PROP_CAN_RAISE },
+	{ RSU_INTERFACE_PROP_CAN_SET_FULLSCREEN, RSU_PROP_CAN_SET_FULLSCREEN },
+	{ RSU_INTERFACE_PROP_HAS_TRACK_LIST, RSU_PROP_HAS_TRACK_LIST },
+	{ RSU_INTERFACE_PROP_IDENTITY, RSU_PROP_IDENTITY },
+	{ RSU_INTERFACE_PROP_SUPPORTED_URIS, RSU_PROP_SUPPORTED_URIS },
+	{ RSU_INTERFACE_PROP_SUPPORTED_MIME, RSU_PROP_SUPPORTED_MIME },
+
+	{ RSU_INTERFACE_PROP_PLAYBACK_STATUS, RSU_PROP_PLAYBACK_STATUS },
+	{ RSU_INTERFACE_PROP_RATE, RSU_PROP_RATE },
+	{ RSU_INTERFACE_PROP_CAN_PLAY, RSU_PROP_CAN_PLAY },
+	{ RSU_INTERFACE_PROP_CAN_SEEK, RSU_PROP_CAN_SEEK },
+	{ RSU_INTERFACE_PROP_CAN_CONTROL, RSU_PROP_CAN_CONTROL },
+	{ RSU_INTERFACE_PROP_CAN_PAUSE, RSU_PROP_CAN_PAUSE },
+	{ RSU_INTERFACE_PROP_CAN_NEXT, RSU_PROP_CAN_NEXT },
+	{ RSU_INTERFACE_PROP_CAN_PREVIOUS, RSU_PROP_CAN_PREVIOUS },
+	{ RSU_INTERFACE_PROP_POSITION, RSU_PROP_POSITION },
+	{ RSU_INTERFACE_PROP_METADATA, RSU_PROP_METADATA },
+	{ RSU_INTERFACE_PROP_TRANSPORT_PLAY_SPEEDS,
+	  RSU_PROP_TRANSPORT_PLAY_SPEEDS },
+	{ RSU_INTERFACE_PROP_MINIMUM_RATE, RSU_PROP_MINIMUM_RATE },
+	{ RSU_INTERFACE_PROP_MAXIMUM_RATE, RSU_PROP_MAXIMUM_RATE },
+	{ RSU_INTERFACE_PROP_VOLUME, RSU_PROP_VOLUME },
+	{ RSU_INTERFACE_PROP_CURRENT_TRACK, RSU_PROP_CURRENT_TRACK },
+	{ RSU_INTERFACE_PROP_NUMBER_OF_TRACKS, RSU_PROP_NUMBER_OF_TRACKS },
+
+	{ RSU_INTERFACE_PROP_DEVICE_TYPE, RSU_PROP_DEVICE_TYPE },
+	{ RSU_INTERFACE_PROP_UDN, RSU_PROP_UDN },
+	{ RSU_INTERFACE_PROP_FRIENDLY_NAME, RSU_PROP_FRIENDLY_NAME },
+	{ RSU_INTERFACE_PROP_ICON_URL, RSU_PROP_ICON_URL },
+	{ RSU_INTERFACE_PROP_MANUFACTURER, RSU_PROP_MANUFACTURER },
+	{ RSU_INTERFACE_PROP_MANUFACTURER_URL, RSU_PROP_MANUFACTURER_URL },
+	{ RSU_INTERFACE_PROP_MODEL_DESCRIPTION, RSU_PROP_MODEL_DESCRIPTION },
+	{ RSU_INTERFACE_PROP_MODEL_NAME, RSU_PROP_MODEL_NAME },
+	{ RSU_INTERFACE_PROP_MODEL_NUMBER, RSU_PROP_MODEL_NUMBER },
+	{ RSU_INTERFACE_PROP_SERIAL_NUMBER, RSU_PROP_SERIAL_NUMBER },
+	{ RSU_INTERFACE_PROP_PRESENTATION_URL, RSU_PROP_PRESENTATION_URL },
+	{ RSU_INTERFACE_PROP_PROTOCOL_INFO, RSU_PROP_PROTOCOL_INFO }
+};
+
+static const gchar * const g_unknown_names[] = {
+	"",
+	"canquit",
+	"CANQUIT",
+	"CanQuit ",
+	" CanQuit",
+	"CanQuitX",
+	"Volum",
+	"Volumes",
+	"Position\n",
+	"Fullscreen",
+	"LoopStatus",
+	"Shuffle",
+	"DesktopEntry",
+	RSU_INTERFACE_SERVER,
+	RSU_INTERFACE_PLAYER,
+	RSU_INTERFACE_PROPERTIES
+};
+
+/* The properties of a device, in slots and in the tables keyed by name
+ * used before, one per interface as in the previous rsu_device_t */
+
+typedef struct test_device_t_ test_device_t;
+struct test_device_t_ {
+	GVariant *values[RSU_PROP_MAX];
+	GHashTable *root_props;
+	GHashTable *player_props;
+	GHashTable *device_props;
+};
+
+static void prv_test_names(void)
+{
+	guint i;
+
+	g_assert_cmpuint(G_N_ELEMENTS(g_props), ==, RSU_PROP_MAX);
+
+	for (i = 0; i < G_N_ELEMENTS(g_props); ++i) {
+		g_assert_cmpint(g_props[i].prop, ==, i);
+		g_assert_cmpint(rsu_prop_from_name(g_props[i].name), ==,
+				g_props[i].prop);
+		g_assert_cmpstr(rsu_prop_get_name(g_props[i].prop), ==,
+				g_props[i].name);
+	}
+}
+
+static void prv_test_unknown_names(void)
+{
+	guint i;
+
+	for (i = 0; i < G_N_ELEMENTS(g_unknown_names); ++i)
+		g_assert_cmpint(rsu_prop_from_name(g_unknown_names[i]), ==,
+				RSU_PROP_MAX);
+}
+
+static GHashTable *prv_device_table(void)
+{
+	return g_hash_table_new_full(g_str_hash, g_str_equal, NULL,
+				     (GDestroyNotify)g_variant_unref);
+}
+
+static void prv_device_init(test_device_t *device)
+{
+	GHashTable *props;
+	guint i;
+
+	device->root_props = prv_device_table();
+	device->player_props = prv_device_table();
+	device->device_props = prv_device_table();
+
+	for (i = 0; i < RSU_PROP_MAX; ++i) {
+		device->values[i] = g_variant_ref_sink(
+					g_variant_new_string(g_props[i].name));
+
+		if (i < RSU_PROP_PLAYER_FIRST)
+			props = device->root_props;
+		else if (i < RSU_PROP_DEVICE_FIRST)
+			props = device->player_props;
+		else
+			props = device->device_props;
+
+		g_hash_table_insert(props, (gpointer)g_props[i].name,
+				    g_variant_ref(device->values[i]));
+	}
+}
+
+static void prv_device_free(test_device_t *device)
+{
+	guint i;
+
+	for (i = 0; i < RSU_PROP_MAX; ++i)
+		g_variant_unref(device->values[i]);
+
+	g_hash_table_unref(device->root_props);
+	g_hash_table_unref(device->player_props);
+	g_hash_table_unref(device->device_props);
+}
+
+/* Same walk as prv_add_props in device.c */
+
+static void prv_add_slots(test_device_t *device, rsu_prop_t first,
+			  rsu_prop_t last, GVariantBuilder *vb)
+{
+	rsu_prop_t prop;
+
+	for (prop = first; prop < last; ++prop)
+		if (device->values[prop])
+			g_variant_builder_add(vb, "{sv}",
+					      rsu_prop_get_name(prop),
+					      device->values[prop]);
+}
+
+static void prv_add_table(GHashTable *props, GVariantBuilder *vb)
+{
+	GHashTableIter iter;
+	gpointer key;
+	gpointer value;
+
+	g_hash_table_iter_init(&iter, props);
+	while (g_hash_table_iter_next(&iter, &key, &value))
+		g_variant_builder_add(vb, "{sv}", key, value);
+}
+
+static void prv_print_result(const gchar *name, guint iterations,
+			     gdouble slots, gdouble tables)
+{
+	g_print("%-8s slots %7.1f ns  tables %7.1f ns\n", name,
+		slots * 1000000000 / iterations,
+		tables * 1000000000 / iterations);
+}
+
+static void prv_benchmark_lookup(void)
+{
+	GHashTable *table;
+	const gchar *name;
+	gdouble slots;
+	gdouble tables;
+	guint sum = 0;
+	guint i;
+
+	table = g_hash_table_new(g_str_hash, g_str_equal);
+	for (i = 0; i < RSU_PROP_MAX; ++i)
+		g_hash_table_insert(table, (gpointer)g_props[i].name,
+				    GUINT_TO_POINTER(g_props[i].prop + 1));
+
+	g_test_timer_start();
+	for (i = 0; i < TEST_ITERATIONS; ++i)
+		sum += rsu_prop_from_name(g_props[i % RSU_PROP_MAX].name);
+	slots = g_test_timer_elapsed();
+
+	g_test_timer_start();
+	for (i = 0; i < TEST_ITERATIONS; ++i) {
+		name = g_props[i % RSU_PROP_MAX].name;
+		sum -= GPOINTER_TO_UINT(g_hash_table_lookup(table, name)) - 1;
+	}
+	tables = g_test_timer_elapsed();
+
+	g_assert_cmpuint(sum, ==, 0);
+	prv_print_result("lookup", TEST_ITERATIONS, slots, tables);
+
+	g_hash_table_unref(table);
+}
+
+static void prv_benchmark_get(void)
+{
+	const gchar *interface_name = RSU_INTERFACE_PLAYER;
+	guint count = RSU_PROP_DEVICE_FIRST - RSU_PROP_PLAYER_FIRST;
+	test_device_t device;
+	const gchar *name;
+	rsu_prop_t prop;
+	GVariant *res;
+	gdouble slots;
+	gdouble tables;
+	guint i;
+
+	prv_device_init(&device);
+
+	/* Get of a Player property, checking it belongs to the interface
+	   as prv_get_prop does */
+
+	g_test_timer_start();
+	for (i = 0; i < TEST_ITERATIONS; ++i) {
+		name = g_props[RSU_PROP_PLAYER_FIRST + i % count].name;
+		prop = rsu_prop_from_name(name);
+		res = NULL;
+		if (!strcmp(interface_name, RSU_INTERFACE_PLAYER) &&
+		    prop >= RSU_PROP_PLAYER_FIRST &&
+		    prop < RSU_PROP_DEVICE_FIRST)
+			res = device.values[prop];
+		g_assert(res);
+	}
+	slots = g_test_timer_elapsed();
+
+	g_test_timer_start();
+	for (i = 0; i < TEST_ITERATIONS; ++i) {
+		name = g_props[RSU_PROP_PLAYER_FIRST + i % count].name;
+		res = NULL;
+		if (!strcmp(interface_name, RSU_INTERFACE_PLAYER))
+			res = g_hash_table_lookup(device.player_props, name);
+		g_assert(res);
+	}
+	tables = g_test_timer_elapsed();
+
+	prv_print_result("Get", TEST_ITERATIONS, slots, tables);
+
+	prv_device_free(&device);
+}
+
+static void prv_benchmark_get_all(void)
+{
+	test_device_t device;
+	GVariantBuilder vb;
+	gdouble slots;
+	gdouble tables;
+	guint i;
+
+	prv_device_init(&device);
+
+	/* GetAll on the root interface, which also lists the properties of
+	   the device */
+
+	g_test_timer_start();
+	for (i = 0; i < TEST_GET_ALL_ITERATIONS; ++i) {
+		g_variant_builder_init(&vb, G_VARIANT_TYPE("a{sv}"));
+		prv_add_slots(&device, RSU_PROP_ROOT_FIRST,
+			      RSU_PROP_PLAYER_FIRST, &vb);
+		prv_add_slots(&device, RSU_PROP_DEVICE_FIRST, RSU_PROP_MAX,
+			      &vb);
+		g_variant_unref(g_variant_ref_sink(g_variant_builder_end(&vb)));
+	}
+	slots = g_test_timer_elapsed();
+
+	g_test_timer_start();
+	for (i = 0; i < TEST_GET_ALL_ITERATIONS; ++i) {
+		g_variant_builder_init(&vb, G_VARIANT_TYPE("a{sv}"));
+		prv_add_table(device.root_props, &vb);
+		prv_add_table(device.device_props, &vb);
+		g_variant_unref(g_variant_ref_sink(g_variant_builder_end(&vb)));
+	}
+	tables = g_test_timer_elapsed();
+
+	prv_print_result("GetAll", TEST_GET_ALL_ITERATIONS, slots, tables);
+
+	prv_device_free(&device);
+}
+
+int main(int argc, char *argv[])
+{
+	g_test_init(&argc, &argv, NULL);
+
+	g_test_add_func("/props/names", prv_test_names);
+	g_test_add_func("/props/unknown-names", prv_test_unknown_names);
+
+	if (g_test_perf()) {
+		g_test_add_func("/props/benchmark/lookup",
+				prv_benchmark_lookup);
+		g_test_add_func("/props/benchmark/get", prv_benchmark_get);
+		g_test_add_func("/props/benchmark/get-all",
+				prv_benchmark_get_all);
+	}
+
+	return g_test_run();
+}